@@ -0,0 +1,74 @@
+/***************************************************************************
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program.  If not, see <http://www.gnu.org/licenses/>. *
+ ***************************************************************************/
+
+/*
+	Computes the CRC of each block of an array, same algorithm as
+	armv7m_crc.s
+
+	parameters:
+	r0 - pointer to struct { uint32_t size_in_crc_out, uint32_t addr },
+	     the array ends with a zero size
+*/
+
+	.text
+	.syntax unified
+	.cpu cortex-m0
+	.thumb
+	.thumb_func
+
+	.align	2
+
+BLOCK_SIZE_RESULT	= 0
+BLOCK_ADDRESS		= 4
+SIZEOF_STRUCT_BLOCK	= 8
+
+start:
+	ldr		r6, CRC32XOR
+block_loop:
+	ldr		r2, [r0, #BLOCK_SIZE_RESULT]	/* get size */
+	tst		r2, r2
+	beq		done
+
+	ldr		r3, [r0, #BLOCK_ADDRESS]	/* get address */
+	movs	r4, #0
+	mvns	r4, r4
+byte_loop:
+	ldrb	r5, [r3]
+	adds	r3, #1
+	lsls	r5, r5, #24
+	eors	r4, r4, r5
+	movs	r5, #8
+bit_loop:
+	lsls	r4, r4, #1
+	bcc		bit_clear
+	eors	r4, r4, r6
+bit_clear:
+	subs	r5, #1
+	bne		bit_loop
+	subs	r2, #1
+	bne		byte_loop
+
+	str		r4, [r0, #BLOCK_SIZE_RESULT]	/* save crc */
+	adds	r0, #SIZEOF_STRUCT_BLOCK
+	b		block_loop
+
+	.align	2
+
+CRC32XOR:	.word	0x04c11db7
+
+done:
+	bkpt	#0
+
+	.end
@@ -0,0 +1,80 @@
+/***************************************************************************
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program.  If not, see <http://www.gnu.org/licenses/>. *
+ ***************************************************************************/
+
+/*
+	Computes the CRC of each block of an array, same algorithm as
+	armv7m_crc_blocks.s. Only uses RV32I instructions which behave the
+	same on RV64I, so one binary serves both.
+
+	parameters:
+	a0 - pointer to struct { uint32_t size_in_crc_out, uint32_t addr },
+	     the array ends with a zero size
+*/
+
+	.text
+	.option norvc
+
+	.align	2
+
+BLOCK_SIZE_RESULT	= 0
+BLOCK_ADDRESS		= 4
+SIZEOF_STRUCT_BLOCK	= 8
+
+/* zero extended 32 bit load, lwu doesn't exist on RV32 */
+.macro	load_u32 rd, offset
+	lhu		\rd, \offset(a0)
+	lhu		t5, \offset + 2(a0)
+	slli	t5, t5, 16
+	or		\rd, \rd, t5
+.endm
+
+start:
+	/* lui/addi, as li would use addiw on RV64 */
+	lui		t6, %hi(0x04c11db7)
+	addi	t6, t6, %lo(0x04c11db7)
+block_loop:
+	/* get size */
+	load_u32	a2, BLOCK_SIZE_RESULT
+	beqz	a2, done
+
+	/* get address */
+	load_u32	a3, BLOCK_ADDRESS
+	li		a4, -1
+byte_loop:
+	lbu		t0, 0(a3)
+	addi	a3, a3, 1
+	slli	t0, t0, 24
+	xor		a4, a4, t0
+	li		t1, 8
+bit_loop:
+	srli	t2, a4, 31		/* bit 31, RV64 keeps more bits above it */
+	andi	t2, t2, 1
+	slli	a4, a4, 1
+	beqz	t2, bit_clear
+	xor		a4, a4, t6
+bit_clear:
+	addi	t1, t1, -1
+	bnez	t1, bit_loop
+	addi	a2, a2, -1
+	bnez	a2, byte_loop
+
+	sw		a4, BLOCK_SIZE_RESULT(a0)	/* save crc */
+	addi	a0, a0, SIZEOF_STRUCT_BLOCK
+	j		block_loop
+
+done:
+	ebreak
+
+	.end
@@ -0,0 +1,87 @@
+/***************************************************************************
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program.  If not, see <http://www.gnu.org/licenses/>. *
+ ***************************************************************************/
+
+/*
+	LZ4 block decompressor
+
+	parameters:
+	r0 - compressed data
+	r1 - end of compressed data
+	r2 - destination in - end of decompressed data out
+*/
+
+	.text
+	.syntax unified
+	.cpu cortex-m0
+	.thumb
+	.thumb_func
+
+	.align	2
+
+_start:
+sequence:
+	cmp		r0, r1
+	bhs		done
+	ldrb	r3, [r0]			/* token */
+	adds	r0, r0, #1
+	lsrs	r4, r3, #4			/* literal length */
+	bl		length
+	cmp		r4, #0
+	beq		literals_done
+literals:
+	ldrb	r5, [r0]
+	adds	r0, r0, #1
+	strb	r5, [r2]
+	adds	r2, r2, #1
+	subs	r4, r4, #1
+	bne		literals
+literals_done:
+	cmp		r0, r1				/* the last sequence has no match */
+	bhs		done
+	ldrb	r5, [r0]			/* match offset */
+	ldrb	r6, [r0, #1]
+	adds	r0, r0, #2
+	lsls	r6, r6, #8
+	orrs	r5, r5, r6
+	subs	r5, r2, r5
+	movs	r4, #15				/* match length */
+	ands	r4, r4, r3
+	bl		length
+	adds	r4, r4, #4
+match:
+	ldrb	r6, [r5]
+	adds	r5, r5, #1
+	strb	r6, [r2]
+	adds	r2, r2, #1
+	subs	r4, r4, #1
+	bne		match
+	b		sequence
+
+length:
+	cmp		r4, #15
+	bne		length_done
+length_byte:
+	ldrb	r6, [r0]
+	adds	r0, r0, #1
+	adds	r4, r4, r6
+	cmp		r6, #255
+	beq		length_byte
+length_done:
+	bx		lr
+
+done:
+	bkpt	#0
+
+	.end
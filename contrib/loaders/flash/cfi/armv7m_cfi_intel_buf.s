@@ -0,0 +1,163 @@
+/***************************************************************************
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program.  If not, see <http://www.gnu.org/licenses/>. *
+ ***************************************************************************/
+
+/*
+	Programs CFI flash with the Intel/Sharp command set using the write
+	buffer (0xe8/0xd0), taking the data from an async algorithm fifo.
+
+	parameters:
+	r0 - fifo start (in), status register on error (out)
+	r1 - fifo end
+	r2 - target address in flash
+	r3 - number of bus words to write
+	r4 - parameter block, see below
+	r5 - bus width in bytes (1, 2 or 4)
+
+	All commands and masks in the parameter block are already replicated
+	for the number of chips on the bus.
+*/
+
+	.text
+	.syntax unified
+	.cpu cortex-m3
+	.thumb
+	.thumb_func
+
+	.align	2
+
+PARAM_BUF_CMD		= 0		/* 0xe8 */
+PARAM_CONFIRM_CMD	= 4		/* 0xd0 */
+PARAM_COUNT_MUL		= 8		/* word count multiplier, 1 per chip */
+PARAM_BUF_SIZE		= 12	/* write buffer size in bytes, power of 2 */
+PARAM_READY_MASK	= 16	/* status bit 7 */
+PARAM_ERROR_MASK	= 20	/* status bits 1..6 */
+
+	b		start
+
+/* r7 = bus word at [r8] */
+read:
+	cmp		r5, #2
+	beq		read16
+	bhi		read32
+	ldrb	r7, [r8]
+	bx		lr
+read16:
+	ldrh	r7, [r8]
+	bx		lr
+read32:
+	ldr		r7, [r8]
+	bx		lr
+
+/* write bus word r7 to [r8] */
+write:
+	cmp		r5, #2
+	beq		write16
+	bhi		write32
+	strb	r7, [r8]
+	bx		lr
+write16:
+	strh	r7, [r8]
+	bx		lr
+write32:
+	str		r7, [r8]
+	bx		lr
+
+start:
+	cmp		r3, #0
+	beq		done
+
+	/* words up to the end of the write buffer, at most r3 */
+	ldr		r6, [r4, #PARAM_BUF_SIZE]
+	subs	r7, r6, #1
+	ands	r7, r7, r2
+	subs	r6, r6, r7
+	udiv	r6, r6, r5
+	cmp		r6, r3
+	it		hi
+	movhi	r6, r3
+
+	/* wait until the fifo holds all of them */
+	mul		r9, r6, r5
+wait_fifo:
+	ldr		r10, [r0, #0]		/* wp */
+	cmp		r10, #0				/* abort if wp == 0 */
+	beq		done
+	ldr		r11, [r0, #4]		/* rp */
+	subs	r10, r10, r11
+	bpl		check_fifo
+	add		r10, r10, r1		/* wrapped: add the fifo size */
+	sub		r10, r10, r0
+	sub		r10, r10, #8
+check_fifo:
+	cmp		r10, r9
+	blo		wait_fifo
+
+	/* write to buffer command, wait for the buffer to be available */
+	mov		r8, r2
+	ldr		r7, [r4, #PARAM_BUF_CMD]
+	bl		write
+wait_buf:
+	bl		read
+	ldr		r12, [r4, #PARAM_READY_MASK]
+	bics	r12, r12, r7
+	bne		wait_buf
+
+	/* word count - 1 */
+	subs	r7, r6, #1
+	ldr		r12, [r4, #PARAM_COUNT_MUL]
+	mul		r7, r7, r12
+	bl		write
+
+	/* copy the data words from the fifo into the flash buffer */
+	mov		r10, r2
+	mov		r9, r6
+copy:
+	mov		r8, r11
+	bl		read
+	add		r11, r11, r5
+	cmp		r11, r1
+	it		cs
+	addcs	r11, r0, #8			/* wrap rp */
+	mov		r8, r10
+	bl		write
+	add		r10, r10, r5
+	subs	r9, r9, #1
+	bne		copy
+
+	/* confirm and wait for the program to finish */
+	mov		r8, r2
+	ldr		r7, [r4, #PARAM_CONFIRM_CMD]
+	bl		write
+wait_prog:
+	bl		read
+	ldr		r12, [r4, #PARAM_READY_MASK]
+	bics	r12, r12, r7
+	bne		wait_prog
+	ldr		r12, [r4, #PARAM_ERROR_MASK]
+	tst		r7, r12
+	bne		error
+
+	str		r11, [r0, #4]		/* release the fifo space */
+	mul		r12, r6, r5
+	add		r2, r2, r12
+	subs	r3, r3, r6
+	b		start
+
+error:
+	movs	r12, #0
+	str		r12, [r0, #4]		/* set rp = 0 on error */
+	mov		r0, r7
+done:
+	bkpt	#0
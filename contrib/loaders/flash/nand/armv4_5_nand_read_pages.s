@@ -0,0 +1,114 @@
+/***************************************************************************
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program.  If not, see <http://www.gnu.org/licenses/>. *
+ ***************************************************************************/
+
+/*
+	Reads consecutive pages of an 8 bit NAND chip on a memory mapped
+	controller. With an ECC controller, its status and parity registers
+	are saved for each page.
+
+	parameters:
+	r0 - parameter block, see arm_io.c
+*/
+
+	.text
+	.syntax unified
+	.arm
+
+	.align	2
+
+	.include "nand_pages.h"
+
+start:
+	ldr		r1, [r0, #PARAM_CMD]
+	ldr		r2, [r0, #PARAM_ADDR]
+	ldr		r3, [r0, #PARAM_DATA]
+	ldr		r4, [r0, #PARAM_DATA_BUF]
+	ldr		r5, [r0, #PARAM_OOB_BUF]
+	ldr		r8, [r0, #PARAM_ECC]
+	ldr		r10, [r0, #PARAM_ECC_BUF]
+	mov		r6, #0					/* page index */
+
+page_loop:
+	ldr		r7, [r0, #PARAM_COUNT]
+	cmp		r6, r7
+	beq		done
+
+	cmp		r8, #0					/* reset the ECC parity */
+	movne	r7, #1
+	strne	r7, [r8, #ECC_CR]
+
+	mov		r7, #NAND_CMD_READ0
+	strb	r7, [r1]
+	ldr		r9, [r0, #PARAM_COL_CYCLES]
+	mov		r7, #0
+column:
+	strb	r7, [r2]
+	subs	r9, r9, #1
+	bne		column
+	ldr		r7, [r0, #PARAM_PAGE]
+	add		r7, r7, r6
+	ldr		r9, [r0, #PARAM_ROW_CYCLES]
+row:
+	strb	r7, [r2]
+	lsr		r7, r7, #8
+	subs	r9, r9, #1
+	bne		row
+	ldr		r9, [r0, #PARAM_COL_CYCLES]
+	cmp		r9, #2					/* large page devices need a start command */
+	moveq	r7, #NAND_CMD_READSTART
+	strbeq	r7, [r1]
+
+	mov		r9, #TWB_LOOPS			/* let the chip go busy */
+twb:
+	subs	r9, r9, #1
+	bne		twb
+	mov		r7, #NAND_CMD_STATUS
+	strb	r7, [r1]
+busy:
+	ldrb	r7, [r3]
+	tst		r7, #NAND_STATUS_READY
+	beq		busy
+	mov		r7, #NAND_CMD_READ0		/* back to data output */
+	strb	r7, [r1]
+
+	ldr		r9, [r0, #PARAM_PAGE_SIZE]
+read_data:
+	ldrb	r7, [r3]
+	strb	r7, [r4], #1
+	subs	r9, r9, #1
+	bne		read_data
+
+	ldr		r9, [r0, #PARAM_OOB_SIZE]
+	cmp		r9, #0
+	beq		read_ecc
+oob_loop:
+	ldrb	r7, [r3]
+	strb	r7, [r5], #1
+	subs	r9, r9, #1
+	bne		oob_loop
+
+read_ecc:
+	cmp		r8, #0
+	ldrne	r7, [r8, #ECC_SR]
+	strne	r7, [r10], #4
+	ldrne	r7, [r8, #ECC_PR]
+	strne	r7, [r10], #4
+
+	add		r6, r6, #1
+	b		page_loop
+
+done:
+	str		r6, [r0, #PARAM_DONE]
+	bkpt	#0
@@ -0,0 +1,117 @@
+/***************************************************************************
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program.  If not, see <http://www.gnu.org/licenses/>. *
+ ***************************************************************************/
+
+/*
+	Programs consecutive pages of an 8 bit NAND chip on a memory mapped
+	controller, polling the status register after each page.
+
+	parameters:
+	r0 - parameter block, see arm_io.c
+*/
+
+	.text
+	.syntax unified
+	.arm
+
+	.align	2
+
+	.include "nand_pages.h"
+
+start:
+	ldr		r1, [r0, #PARAM_CMD]
+	ldr		r2, [r0, #PARAM_ADDR]
+	ldr		r3, [r0, #PARAM_DATA]
+	ldr		r4, [r0, #PARAM_DATA_BUF]
+	ldr		r5, [r0, #PARAM_OOB_BUF]
+	ldr		r8, [r0, #PARAM_ECC]
+	mov		r6, #0					/* page index */
+
+page_loop:
+	ldr		r7, [r0, #PARAM_COUNT]
+	cmp		r6, r7
+	beq		done
+
+	cmp		r8, #0					/* reset the ECC parity */
+	movne	r7, #1
+	strne	r7, [r8, #ECC_CR]
+
+	mov		r7, #NAND_CMD_SEQIN
+	strb	r7, [r1]
+	ldr		r9, [r0, #PARAM_COL_CYCLES]
+	mov		r7, #0
+column:
+	strb	r7, [r2]
+	subs	r9, r9, #1
+	bne		column
+	ldr		r7, [r0, #PARAM_PAGE]
+	add		r7, r7, r6
+	ldr		r9, [r0, #PARAM_ROW_CYCLES]
+row:
+	strb	r7, [r2]
+	lsr		r7, r7, #8
+	subs	r9, r9, #1
+	bne		row
+
+	ldr		r9, [r0, #PARAM_PAGE_SIZE]
+write_data:
+	ldrb	r7, [r4], #1
+	strb	r7, [r3]
+	subs	r9, r9, #1
+	bne		write_data
+
+	cmp		r8, #0					/* ECC parity goes to the spare area */
+	beq		write_oob
+	ldr		r7, [r8, #ECC_PR]
+	strb	r7, [r5, #0]
+	lsr		r7, r7, #8
+	strb	r7, [r5, #1]
+	ldr		r7, [r8, #ECC_NPR]
+	strb	r7, [r5, #2]
+	lsr		r7, r7, #8
+	strb	r7, [r5, #3]
+
+write_oob:
+	ldr		r9, [r0, #PARAM_OOB_SIZE]
+	cmp		r9, #0
+	beq		program
+oob_loop:
+	ldrb	r7, [r5], #1
+	strb	r7, [r3]
+	subs	r9, r9, #1
+	bne		oob_loop
+
+program:
+	mov		r7, #NAND_CMD_PAGEPROG
+	strb	r7, [r1]
+	mov		r9, #TWB_LOOPS			/* let the chip go busy */
+twb:
+	subs	r9, r9, #1
+	bne		twb
+	mov		r7, #NAND_CMD_STATUS
+	strb	r7, [r1]
+busy:
+	ldrb	r7, [r3]
+	tst		r7, #NAND_STATUS_READY
+	beq		busy
+	tst		r7, #NAND_STATUS_FAIL
+	strne	r7, [r0, #PARAM_STATUS]
+	bne		done
+
+	add		r6, r6, #1
+	b		page_loop
+
+done:
+	str		r6, [r0, #PARAM_DONE]
+	bkpt	#0
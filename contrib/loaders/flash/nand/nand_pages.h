@@ -0,0 +1,47 @@
+/***************************************************************************
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program.  If not, see <http://www.gnu.org/licenses/>. *
+ ***************************************************************************/
+
+/* parameter block of the NAND page loaders, must match arm_io.c */
+PARAM_CMD			= 0		/* command latch address */
+PARAM_ADDR			= 4		/* address latch address */
+PARAM_DATA			= 8		/* data register address */
+PARAM_ECC			= 12	/* AT91SAM9 style ECC controller, 0 if none */
+PARAM_PAGE			= 16	/* first page */
+PARAM_COUNT			= 20	/* number of pages */
+PARAM_PAGE_SIZE		= 24	/* data bytes per page */
+PARAM_OOB_SIZE		= 28	/* spare bytes per page, may be 0 */
+PARAM_COL_CYCLES	= 32	/* 1 for small, 2 for large page devices */
+PARAM_ROW_CYCLES	= 36
+PARAM_DATA_BUF		= 40	/* page data, PARAM_COUNT * PARAM_PAGE_SIZE */
+PARAM_OOB_BUF		= 44	/* spare areas, PARAM_COUNT * PARAM_OOB_SIZE */
+PARAM_ECC_BUF		= 48	/* read: ECC status and parity for each page */
+PARAM_DONE			= 52	/* out: number of pages done */
+PARAM_STATUS		= 56	/* out: status of a failed program, else 0 */
+
+ECC_CR				= 0x00
+ECC_SR				= 0x08
+ECC_PR				= 0x0c
+ECC_NPR				= 0x10
+
+NAND_CMD_READ0		= 0x00
+NAND_CMD_PAGEPROG	= 0x10
+NAND_CMD_READSTART	= 0x30
+NAND_CMD_STATUS		= 0x70
+NAND_CMD_SEQIN		= 0x80
+
+NAND_STATUS_FAIL	= 0x01
+NAND_STATUS_READY	= 0x40
+
+TWB_LOOPS			= 32
@@ -21,6 +21,14 @@
 
 #include "common.h"
 #include <helper/log.h>
+#include <helper/fileio.h>
+#include <target/image.h>
+#include <unistd.h>
+
+#define FLASH_STATE_CACHE_MAGIC		0x4f435343	/* "OCSC" */
+#define FLASH_STATE_CACHE_VERSION	1
+
+static char *flash_state_cache_dir;
 
 unsigned get_flash_name_index(const char *name)
 {
@@ -45,3 +53,133 @@ bool flash_driver_name_matches(const char *name, const char *expected)
 	/* ...then check that name terminates at this spot. */
 	return expected[blen] == '.' || expected[blen] == '\0';
 }
+
+void flash_state_cache_set_dir(const char *dir)
+{
+	free(flash_state_cache_dir);
+	flash_state_cache_dir = (dir && *dir) ? strdup(dir) : NULL;
+}
+
+const char *flash_state_cache_get_dir(void)
+{
+	return flash_state_cache_dir;
+}
+
+static char *flash_state_cache_path(const char *key)
+{
+	if (!flash_state_cache_dir)
+		return NULL;
+	return alloc_printf("%s/%s.cache", flash_state_cache_dir, key);
+}
+
+int flash_state_cache_load(const char *key, uint32_t fingerprint,
+		int8_t *states, unsigned count)
+{
+	char *path = flash_state_cache_path(key);
+	if (!path)
+		return ERROR_FAIL;
+
+	/* a cache miss is the common case, don't let fileio complain about it */
+	struct fileio *fileio;
+	int retval = ERROR_FAIL;
+	if (access(path, R_OK) == 0)
+		retval = fileio_open(&fileio, path, FILEIO_READ, FILEIO_BINARY);
+	if (retval != ERROR_OK) {
+		free(path);
+		return ERROR_FAIL;
+	}
+
+	uint32_t magic = 0, version = 0, stored_fingerprint = 0;
+	uint32_t stored_count = 0, stored_crc = 0, crc;
+	size_t size_read = 0;
+	retval = fileio_read_u32(fileio, &magic);
+	if (retval == ERROR_OK)
+		retval = fileio_read_u32(fileio, &version);
+	if (retval == ERROR_OK)
+		retval = fileio_read_u32(fileio, &stored_fingerprint);
+	if (retval == ERROR_OK)
+		retval = fileio_read_u32(fileio, &stored_count);
+	if (retval == ERROR_OK)
+		retval = fileio_read_u32(fileio, &stored_crc);
+	if (retval == ERROR_OK && magic == FLASH_STATE_CACHE_MAGIC
+			&& version == FLASH_STATE_CACHE_VERSION
+			&& stored_count == count)
+		retval = fileio_read(fileio, count, states, &size_read);
+	else
+		retval = ERROR_FAIL;
+	fileio_close(fileio);
+
+	if (retval == ERROR_OK && size_read == count
+			&& image_calculate_checksum((uint8_t *)states, count, &crc) == ERROR_OK
+			&& crc == stored_crc) {
+		if (stored_fingerprint == fingerprint) {
+			LOG_DEBUG("restored %u states from %s", count, path);
+			free(path);
+			return ERROR_OK;
+		}
+		LOG_INFO("%s: contents changed, discarding cached state", path);
+	} else
+		LOG_WARNING("%s: ignoring invalid state cache", path);
+
+	/* the file no longer describes the device */
+	unlink(path);
+	free(path);
+	return ERROR_FAIL;
+}
+
+int flash_state_cache_store(const char *key, uint32_t fingerprint,
+		const int8_t *states, unsigned count)
+{
+	char *path = flash_state_cache_path(key);
+	if (!path)
+		return ERROR_OK;
+
+	uint32_t crc;
+	int retval = image_calculate_checksum((const uint8_t *)states, count, &crc);
+	if (retval != ERROR_OK) {
+		free(path);
+		return retval;
+	}
+
+	struct fileio *fileio;
+	retval = fileio_open(&fileio, path, FILEIO_WRITE, FILEIO_BINARY);
+	if (retval != ERROR_OK) {
+		LOG_WARNING("can't write state cache %s", path);
+		free(path);
+		return retval;
+	}
+
+	size_t size_written = 0;
+	retval = fileio_write_u32(fileio, FLASH_STATE_CACHE_MAGIC);
+	if (retval == ERROR_OK)
+		retval = fileio_write_u32(fileio, FLASH_STATE_CACHE_VERSION);
+	if (retval == ERROR_OK)
+		retval = fileio_write_u32(fileio, fingerprint);
+	if (retval == ERROR_OK)
+		retval = fileio_write_u32(fileio, count);
+	if (retval == ERROR_OK)
+		retval = fileio_write_u32(fileio, crc);
+	if (retval == ERROR_OK)
+		retval = fileio_write(fileio, count, states, &size_written);
+	fileio_close(fileio);
+
+	if (retval != ERROR_OK || size_written != count) {
+		LOG_WARNING("can't write state cache %s", path);
+		unlink(path);
+		retval = ERROR_FAIL;
+	} else
+		LOG_DEBUG("stored %u states to %s", count, path);
+
+	free(path);
+	return retval;
+}
+
+void flash_state_cache_drop(const char *key)
+{
+	char *path = flash_state_cache_path(key);
+	if (!path)
+		return;
+	if (unlink(path) == 0)
+		LOG_DEBUG("dropped state cache %s", path);
+	free(path);
+}
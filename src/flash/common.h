@@ -35,6 +35,31 @@ unsigned get_flash_name_index(const char *name);
  */
 bool flash_driver_name_matches(const char *name, const char *expected);
 
+/**
+ * Sets the directory holding the on-disk bad block and erase state
+ * cache shared by NOR banks and NAND devices.
+ * @param dir The directory, or NULL to disable the cache.
+ */
+void flash_state_cache_set_dir(const char *dir);
+/** @returns The cache directory, or NULL if the cache is disabled. */
+const char *flash_state_cache_get_dir(void);
+/**
+ * Restores per sector (or per block) states from the cache.
+ * @param key Identifies the device; used to build the file name.
+ * @param fingerprint Cheap checksum of the device contents; the cached
+ * states are only used if it matches the one they were stored with.
+ * @param states Receives @a count entries of -1 (unknown), 0 or 1.
+ * @param count The number of sectors or blocks of the device.
+ * @returns ERROR_OK on a cache hit, ERROR_FAIL otherwise.
+ */
+int flash_state_cache_load(const char *key, uint32_t fingerprint,
+		int8_t *states, unsigned count);
+/** Stores @a count states for @a key, replacing any previous entry. */
+int flash_state_cache_store(const char *key, uint32_t fingerprint,
+		const int8_t *states, unsigned count);
+/** Removes the cache entry for @a key, if there is one. */
+void flash_state_cache_drop(const char *key);
+
 #define ERROR_FLASH_BANK_INVALID			(-900)
 #define ERROR_FLASH_SECTOR_INVALID			(-901)
 #define ERROR_FLASH_OPERATION_FAILED		(-902)
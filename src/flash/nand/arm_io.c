@@ -297,3 +297,220 @@ int arm_nandread(struct arm_nand_data *nand, uint8_t *data, uint32_t size)
 
 	return retval;
 }
+
+/* parameter block of the page loaders, see contrib/loaders/flash/nand */
+enum arm_nand_pages_param {
+	PARAM_CMD,
+	PARAM_ADDR,
+	PARAM_DATA,
+	PARAM_ECC,
+	PARAM_PAGE,
+	PARAM_COUNT,
+	PARAM_PAGE_SIZE,
+	PARAM_OOB_SIZE,
+	PARAM_COL_CYCLES,
+	PARAM_ROW_CYCLES,
+	PARAM_DATA_BUF,
+	PARAM_OOB_BUF,
+	PARAM_ECC_BUF,
+	PARAM_DONE,
+	PARAM_STATUS,
+	PARAM_NUM
+};
+
+#define ARM_NAND_PAGES_MAX	64
+
+/**
+ * Runs one of the page loaders on as many pages per run as fit into a
+ * working area. For writes, @a data and @a oob are copied to the target,
+ * for reads they're filled from it.
+ */
+static int arm_nand_run_pages(struct arm_nand_data *nand, struct nand_device *device,
+		const uint8_t *code, unsigned code_size, bool write,
+		uint32_t page, uint32_t count, uint8_t *data,
+		uint8_t *oob, uint32_t oob_size, uint32_t *ecc)
+{
+	struct target *target = nand->target;
+	struct arm *arm = target_to_arm(target);
+	struct arm_algorithm armv4_5_algo;
+	struct working_area *area = NULL;
+	struct reg_param reg_params[1];
+	uint32_t params[PARAM_NUM];
+	uint8_t params_buf[sizeof(params)];
+	uint32_t page_size = device->page_size;
+	uint32_t ecc_active, max_pages, pages_size, exit_var = 0;
+	uint8_t *oob_buf;
+	int retval = ERROR_OK;
+
+	/* only the ARM state loaders exist; NAND controllers live next to ARM9 cores */
+	if (!nand->cmd || !nand->addr || !is_arm(arm)
+			|| is_armv7m(target_to_armv7m(target)))
+		return ERROR_NAND_OPERATION_NOT_SUPPORTED;
+
+	/* with user supplied spare data the ECC parity must not replace it */
+	ecc_active = (write && oob) ? 0 : nand->ecc;
+
+	max_pages = MIN(count, ARM_NAND_PAGES_MAX);
+	for (;;) {
+		pages_size = max_pages * (page_size + oob_size + 2 * sizeof(uint32_t));
+		if (target_alloc_working_area_try(target, code_size + sizeof(params) + pages_size,
+				&area) == ERROR_OK)
+			break;
+		max_pages /= 2;
+		if (max_pages == 0) {
+			LOG_DEBUG("no working area for NAND page loader");
+			return ERROR_NAND_NO_BUFFER;
+		}
+	}
+
+	/* staging for spare areas the caller didn't supply, and ECC results */
+	oob_buf = malloc(max_pages * MAX(oob_size, 2 * sizeof(uint32_t)));
+	if (!oob_buf) {
+		target_free_working_area(target, area);
+		return ERROR_FAIL;
+	}
+
+	retval = target_write_buffer(target, area->address, code_size, code);
+	if (retval != ERROR_OK)
+		goto out;
+
+	armv4_5_algo.common_magic = ARM_COMMON_MAGIC;
+	armv4_5_algo.core_mode = ARM_MODE_SVC;
+	armv4_5_algo.core_state = ARM_STATE_ARM;
+
+	/* armv4 must exit using a hardware breakpoint */
+	if (arm->is_armv4)
+		exit_var = area->address + code_size - 4;
+
+	uint32_t params_addr = area->address + code_size;
+	uint32_t data_addr = params_addr + sizeof(params);
+	uint32_t oob_addr = data_addr + max_pages * page_size;
+	uint32_t ecc_addr = oob_addr + max_pages * oob_size;
+
+	params[PARAM_CMD] = nand->cmd;
+	params[PARAM_ADDR] = nand->addr;
+	params[PARAM_DATA] = nand->data;
+	params[PARAM_ECC] = ecc_active;
+	params[PARAM_PAGE_SIZE] = page_size;
+	params[PARAM_OOB_SIZE] = oob_size;
+	params[PARAM_COL_CYCLES] = (page_size <= 512) ? 1 : 2;
+	params[PARAM_ROW_CYCLES] = device->address_cycles - params[PARAM_COL_CYCLES];
+	params[PARAM_DATA_BUF] = data_addr;
+	params[PARAM_OOB_BUF] = oob_addr;
+	params[PARAM_ECC_BUF] = ecc_addr;
+
+	init_reg_param(&reg_params[0], "r0", 32, PARAM_OUT);
+	buf_set_u32(reg_params[0].value, 0, 32, params_addr);
+
+	while (count > 0) {
+		uint32_t n = MIN(count, max_pages);
+
+		params[PARAM_PAGE] = page;
+		params[PARAM_COUNT] = n;
+		params[PARAM_DONE] = 0;
+		params[PARAM_STATUS] = 0;
+		target_buffer_set_u32_array(target, params_buf, PARAM_NUM, params);
+		retval = target_write_buffer(target, params_addr, sizeof(params_buf), params_buf);
+		if (retval != ERROR_OK)
+			break;
+
+		if (write) {
+			retval = target_write_buffer(target, data_addr, n * page_size, data);
+			if (retval != ERROR_OK)
+				break;
+			if (oob_size) {
+				if (oob)
+					memcpy(oob_buf, oob, n * oob_size);
+				else
+					memset(oob_buf, 0xff, n * oob_size);
+				retval = target_write_buffer(target, oob_addr, n * oob_size, oob_buf);
+				if (retval != ERROR_OK)
+					break;
+			}
+		}
+
+		retval = target_run_algorithm(target, 0, NULL, 1, reg_params,
+				area->address, exit_var, 1000 + 10 * n, &armv4_5_algo);
+		if (retval != ERROR_OK) {
+			LOG_ERROR("error executing hosted NAND page %s",
+				write ? "write" : "read");
+			break;
+		}
+
+		retval = target_read_buffer(target, params_addr, sizeof(params_buf), params_buf);
+		if (retval != ERROR_OK)
+			break;
+		target_buffer_get_u32_array(target, params_buf, PARAM_NUM, params);
+		if (params[PARAM_DONE] != n) {
+			LOG_ERROR("NAND page 0x%" PRIx32 " failed, status 0x%02" PRIx32,
+				page + params[PARAM_DONE], params[PARAM_STATUS]);
+			retval = ERROR_NAND_OPERATION_FAILED;
+			break;
+		}
+
+		if (!write) {
+			retval = target_read_buffer(target, data_addr, n * page_size, data);
+			if (retval == ERROR_OK && oob)
+				retval = target_read_buffer(target, oob_addr, n * oob_size, oob);
+			if (retval == ERROR_OK && ecc && ecc_active) {
+				retval = target_read_buffer(target, ecc_addr,
+						n * 2 * sizeof(uint32_t), oob_buf);
+				target_buffer_get_u32_array(target, oob_buf, 2 * n, ecc);
+				ecc += 2 * n;
+			}
+			if (retval != ERROR_OK)
+				break;
+		}
+
+		page += n;
+		count -= n;
+		data += n * page_size;
+		if (oob)
+			oob += n * oob_size;
+
+		keep_alive();
+	}
+
+	destroy_reg_param(&reg_params[0]);
+
+out:
+	free(oob_buf);
+	target_free_working_area(target, area);
+	return retval;
+}
+
+/**
+ * Programs @a count pages starting at @a page, running the whole NAND
+ * command sequence on the target. @a oob holds @a oob_size spare bytes per
+ * page; if it's NULL the spare areas are left erased, except for the parity
+ * of the ECC controller if there is one.
+ */
+int arm_nandwrite_pages(struct arm_nand_data *nand, struct nand_device *device,
+		uint32_t page, uint32_t count, const uint8_t *data,
+		const uint8_t *oob, uint32_t oob_size)
+{
+	static const uint8_t code[] = {
+#include "../../../contrib/loaders/flash/nand/armv4_5_nand_write_pages.inc"
+	};
+
+	return arm_nand_run_pages(nand, device, code, sizeof(code), true, page, count,
+			(uint8_t *)data, (uint8_t *)oob, oob_size, NULL);
+}
+
+/**
+ * Reads @a count pages starting at @a page on the target. Spare areas are
+ * read if @a oob_size is non-zero, but only returned if @a oob is set. With
+ * an ECC controller, @a ecc (if set) receives its status and parity
+ * registers for each page.
+ */
+int arm_nandread_pages(struct arm_nand_data *nand, struct nand_device *device,
+		uint32_t page, uint32_t count, uint8_t *data,
+		uint8_t *oob, uint32_t oob_size, uint32_t *ecc)
+{
+	static const uint8_t code[] = {
+#include "../../../contrib/loaders/flash/nand/armv4_5_nand_read_pages.inc"
+	};
+
+	return arm_nand_run_pages(nand, device, code, sizeof(code), false, page, count,
+			data, oob, oob_size, ecc);
+}
@@ -43,6 +43,15 @@ struct arm_nand_data {
 	/** Where data is read from or written to. */
 	uint32_t data;
 
+	/** Command latch address, 0 if whole pages can't be done on the target. */
+	uint32_t cmd;
+
+	/** Address latch address. */
+	uint32_t addr;
+
+	/** ECC controller with the AT91SAM9 register layout, or 0. */
+	uint32_t ecc;
+
 	/** Last operation executed using this struct. */
 	enum arm_nand_op op;
 
@@ -52,4 +61,11 @@ struct arm_nand_data {
 int arm_nandwrite(struct arm_nand_data *nand, uint8_t *data, int size);
 int arm_nandread(struct arm_nand_data *nand, uint8_t *data, uint32_t size);
 
+int arm_nandwrite_pages(struct arm_nand_data *nand, struct nand_device *device,
+		uint32_t page, uint32_t count, const uint8_t *data,
+		const uint8_t *oob, uint32_t oob_size);
+int arm_nandread_pages(struct arm_nand_data *nand, struct nand_device *device,
+		uint32_t page, uint32_t count, uint8_t *data,
+		uint8_t *oob, uint32_t oob_size, uint32_t *ecc);
+
 #endif /* OPENOCD_FLASH_NAND_ARM_IO_H */
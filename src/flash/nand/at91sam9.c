@@ -345,6 +345,49 @@ static uint8_t *at91sam9_oob_init(struct nand_device *nand, uint8_t *oob, uint32
 	return oob;
 }
 
+/**
+ * Size of the spare area used when the caller doesn't supply one.
+ *
+ * @param nand NAND device the spare area belongs to.
+ * @return Size of the spare area in bytes.
+ */
+static uint32_t at91sam9_oob_size(struct nand_device *nand)
+{
+	return nand->page_size == 512 ? 16 : 64;
+}
+
+/**
+ * Check the ECC controller status after a page was read and correct a single
+ * bit error in the data.
+ *
+ * @param data Page data that was read.
+ * @param status Value of the ECC status register.
+ * @param parity Value of the ECC parity register, only used on errors.
+ */
+static void at91sam9_ecc_correct(uint8_t *data, uint32_t status, uint32_t parity)
+{
+	if (status & 1) {
+		LOG_ERROR("Error detected!");
+		if (status & 4)
+			LOG_ERROR("Multiple errors encountered; unrecoverable!");
+		else {
+			/* attempt recovery */
+			uint32_t word = (parity & 0x0000FFF0) >> 4;
+			uint32_t bit = parity & 0x0F;
+
+			data[word] ^= (0x1) << bit;
+			LOG_INFO("Data word %d, bit %d corrected.",
+				(unsigned) word,
+				(unsigned) bit);
+		}
+	}
+
+	if (status & 2) {
+		/* we could write back correct ECC data */
+		LOG_ERROR("Error in ECC bytes detected");
+	}
+}
+
 /**
  * Reads a page from an AT91SAM9 NAND controller and verifies using 1-bit ECC
  * controller on chip.  This makes an attempt to correct any errors that are
@@ -365,7 +408,7 @@ static int at91sam9_read_page(struct nand_device *nand, uint32_t page,
 	struct at91sam9_nand *info = nand->controller_priv;
 	struct target *target = nand->target;
 	uint8_t *oob_data;
-	uint32_t status;
+	uint32_t status, parity = 0;
 
 	retval = at91sam9_ecc_init(target, info);
 	if (ERROR_OK != retval)
@@ -385,31 +428,9 @@ static int at91sam9_read_page(struct nand_device *nand, uint32_t page,
 	retval = nand_read_data_page(nand, oob_data, oob_size);
 	if (ERROR_OK == retval && data) {
 		target_read_u32(target, info->ecc + AT91C_ECCx_SR, &status);
-		if (status & 1) {
-			LOG_ERROR("Error detected!");
-			if (status & 4)
-				LOG_ERROR("Multiple errors encountered; unrecoverable!");
-			else {
-				/* attempt recovery */
-				uint32_t parity;
-
-				target_read_u32(target,
-					info->ecc + AT91C_ECCx_PR,
-					&parity);
-				uint32_t word = (parity & 0x0000FFF0) >> 4;
-				uint32_t bit = parity & 0x0F;
-
-				data[word] ^= (0x1) << bit;
-				LOG_INFO("Data word %d, bit %d corrected.",
-					(unsigned) word,
-					(unsigned) bit);
-			}
-		}
-
-		if (status & 2) {
-			/* we could write back correct ECC data */
-			LOG_ERROR("Error in ECC bytes detected");
-		}
+		if (status & 1)
+			target_read_u32(target, info->ecc + AT91C_ECCx_PR, &parity);
+		at91sam9_ecc_correct(data, status, parity);
 	}
 
 	if (!oob) {
@@ -486,6 +507,103 @@ static int at91sam9_write_page(struct nand_device *nand, uint32_t page,
 	return retval;
 }
 
+/**
+ * Point the hosted page loaders at the current controller addresses.
+ *
+ * @param info NAND controller information.
+ * @return I/O structure for the hosted page loaders.
+ */
+static struct arm_nand_data *at91sam9_pages_io(struct at91sam9_nand *info)
+{
+	info->io.cmd = info->cmd;
+	info->io.addr = info->addr;
+	info->io.ecc = info->ecc;
+
+	return &info->io;
+}
+
+/**
+ * Read consecutive pages with the whole command sequence running on the
+ * target, then check and correct each page using the ECC status the loader
+ * saved.
+ *
+ * @param nand NAND device to read from.
+ * @param page First page to read.
+ * @param count Number of pages.
+ * @param data Where @a count pages of data should be put.
+ * @param oob Where @a count spare areas should be put, or NULL.
+ * @param oob_size Size of one spare area.
+ * @return Success or failure of reading the NAND pages.
+ */
+static int at91sam9_read_pages(struct nand_device *nand, uint32_t page, uint32_t count,
+	uint8_t *data, uint8_t *oob, uint32_t oob_size)
+{
+	struct at91sam9_nand *info = nand->controller_priv;
+	uint32_t *ecc;
+	int retval;
+
+	if (!at91sam9_halted(nand->target, "read pages"))
+		return ERROR_NAND_OPERATION_FAILED;
+
+	retval = at91sam9_ecc_init(nand->target, info);
+	if (ERROR_OK != retval)
+		return retval;
+
+	ecc = malloc(count * 2 * sizeof(uint32_t));
+	if (!ecc) {
+		LOG_ERROR("Unable to allocate space for ECC status");
+		return ERROR_NAND_OPERATION_FAILED;
+	}
+
+	if (!oob)
+		oob_size = at91sam9_oob_size(nand);
+
+	at91sam9_enable(nand);
+	retval = arm_nandread_pages(at91sam9_pages_io(info), nand, page, count,
+			data, oob, oob_size, ecc);
+	if (ERROR_OK == retval) {
+		for (uint32_t i = 0; i < count; i++)
+			at91sam9_ecc_correct(data + i * nand->page_size, ecc[2 * i], ecc[2 * i + 1]);
+	}
+
+	free(ecc);
+	return retval;
+}
+
+/**
+ * Write consecutive pages with the whole command sequence running on the
+ * target. Like at91sam9_write_page(), the ECC parity is stored in the spare
+ * area unless OOB data is given.
+ *
+ * @param nand NAND device to write to.
+ * @param page First page to write.
+ * @param count Number of pages.
+ * @param data Data of @a count pages.
+ * @param oob @a count spare areas, or NULL.
+ * @param oob_size Size of one spare area.
+ * @return Success or failure of the page writes.
+ */
+static int at91sam9_write_pages(struct nand_device *nand, uint32_t page, uint32_t count,
+	uint8_t *data, uint8_t *oob, uint32_t oob_size)
+{
+	struct at91sam9_nand *info = nand->controller_priv;
+	int retval;
+
+	if (!at91sam9_halted(nand->target, "write pages"))
+		return ERROR_NAND_OPERATION_FAILED;
+
+	retval = at91sam9_ecc_init(nand->target, info);
+	if (ERROR_OK != retval)
+		return retval;
+
+	if (!oob)
+		oob_size = at91sam9_oob_size(nand);
+
+	at91sam9_enable(nand);
+	return arm_nandwrite_pages(at91sam9_pages_io(info), nand, page, count,
+			data, oob, oob_size);
+}
+
 /**
  * Handle the initial NAND device command for AT91SAM9 controllers.  This
  * initializes much of the controller information struct to be ready for future
@@ -719,4 +837,6 @@ struct nand_flash_controller at91sam9_nand_controller = {
 	.write_block_data = at91sam9_write_block_data,
 	.read_page = at91sam9_read_page,
 	.write_page = at91sam9_write_page,
+	.read_pages = at91sam9_read_pages,
+	.write_pages = at91sam9_write_pages,
 };
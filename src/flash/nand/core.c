@@ -24,6 +24,7 @@
 #endif
 
 #include "imp.h"
+#include <target/image.h>
 
 /* configured NAND devices and NAND Flash command handler */
 struct nand_device *nand_devices;
@@ -257,6 +258,88 @@ int nand_build_bbt(struct nand_device *nand, int first, int last)
 	return ERROR_OK;
 }
 
+static void nand_state_cache_key(struct nand_device *nand, char *key, size_t size)
+{
+	/* the device name keeps identical chips on one controller apart */
+	snprintf(key, size, "nand-%s-%s-%02x-%02x-%d",
+		nand->name, nand->controller->name, nand->manufacturer->id,
+		nand->device->id, nand->num_blocks);
+}
+
+/* CRC of the raw first page, including its spare area */
+static int nand_state_cache_fingerprint(struct nand_device *nand,
+	uint32_t *fingerprint)
+{
+	uint32_t oob_size = nand->page_size / 32;
+	uint8_t *page = malloc(nand->page_size + oob_size);
+	if (!page)
+		return ERROR_FAIL;
+
+	int retval = nand_read_page_raw(nand, 0, page, nand->page_size,
+			page + nand->page_size, oob_size);
+	if (retval == ERROR_OK)
+		retval = image_calculate_checksum(page, nand->page_size + oob_size,
+				fingerprint);
+	free(page);
+	return retval;
+}
+
+int nand_state_cache_restore(struct nand_device *nand)
+{
+	if (!flash_state_cache_get_dir() || !nand->device)
+		return ERROR_OK;
+
+	/* a missing cache entry must never fail the probe */
+	uint32_t fingerprint;
+	if (nand_state_cache_fingerprint(nand, &fingerprint) != ERROR_OK)
+		return ERROR_OK;
+
+	int8_t *states = malloc(2 * nand->num_blocks);
+	if (!states)
+		return ERROR_OK;
+
+	char key[160];
+	nand_state_cache_key(nand, key, sizeof(key));
+	if (flash_state_cache_load(key, fingerprint, states,
+			2 * nand->num_blocks) == ERROR_OK) {
+		for (int i = 0; i < nand->num_blocks; i++) {
+			nand->blocks[i].is_bad = states[i];
+			nand->blocks[i].is_erased = states[nand->num_blocks + i];
+		}
+		LOG_INFO("restored bad block table of '%s' from state cache",
+			nand->device->name);
+	}
+	free(states);
+	return ERROR_OK;
+}
+
+int nand_state_cache_update(struct nand_device *nand)
+{
+	if (!flash_state_cache_get_dir() || !nand->device)
+		return ERROR_OK;
+
+	uint32_t fingerprint;
+	int retval = nand_state_cache_fingerprint(nand, &fingerprint);
+	if (retval != ERROR_OK)
+		return retval;
+
+	int8_t *states = malloc(2 * nand->num_blocks);
+	if (!states)
+		return ERROR_FAIL;
+
+	for (int i = 0; i < nand->num_blocks; i++) {
+		states[i] = nand->blocks[i].is_bad;
+		states[nand->num_blocks + i] = nand->blocks[i].is_erased;
+	}
+
+	char key[160];
+	nand_state_cache_key(nand, key, sizeof(key));
+	retval = flash_state_cache_store(key, fingerprint, states,
+			2 * nand->num_blocks);
+	free(states);
+	return retval;
+}
+
 int nand_read_status(struct nand_device *nand, uint8_t *status)
 {
 	if (!nand->device)
@@ -490,7 +573,7 @@ int nand_probe(struct nand_device *nand)
 		nand->blocks[i].is_bad = -1;
 	}
 
-	return ERROR_OK;
+	return nand_state_cache_restore(nand);
 }
 
 int nand_erase(struct nand_device *nand, int first_block, int last_block)
@@ -684,6 +767,76 @@ int nand_read_page(struct nand_device *nand, uint32_t page,
 		return nand->controller->read_page(nand, page, data, data_size, oob, oob_size);
 }
 
+/* controller page batches that didn't run and should be done page by page */
+static bool nand_pages_fallback(int retval)
+{
+	return retval == ERROR_NAND_OPERATION_NOT_SUPPORTED || retval == ERROR_NAND_NO_BUFFER;
+}
+
+int nand_write_pages(struct nand_device *nand, uint32_t page, uint32_t count,
+	uint8_t *data, uint8_t *oob, uint32_t oob_size)
+{
+	int retval;
+
+	if (!nand->device)
+		return ERROR_NAND_DEVICE_NOT_PROBED;
+
+	if (count == 0)
+		return ERROR_OK;
+
+	if (data && !nand->use_raw && nand->controller->write_pages) {
+		uint32_t pages_per_block = nand->erase_size / nand->page_size;
+		uint32_t last = (page + count - 1) / pages_per_block;
+
+		for (uint32_t block = page / pages_per_block; block <= last; block++) {
+			if (nand->blocks[block].is_erased == 1)
+				nand->blocks[block].is_erased = 0;
+		}
+
+		retval = nand->controller->write_pages(nand, page, count, data, oob, oob_size);
+		if (!nand_pages_fallback(retval))
+			return retval;
+	}
+
+	for (uint32_t i = 0; i < count; i++) {
+		retval = nand_write_page(nand, page + i,
+				data ? data + i * nand->page_size : NULL, data ? nand->page_size : 0,
+				oob ? oob + i * oob_size : NULL, oob_size);
+		if (retval != ERROR_OK)
+			return retval;
+	}
+
+	return ERROR_OK;
+}
+
+int nand_read_pages(struct nand_device *nand, uint32_t page, uint32_t count,
+	uint8_t *data, uint8_t *oob, uint32_t oob_size)
+{
+	int retval;
+
+	if (!nand->device)
+		return ERROR_NAND_DEVICE_NOT_PROBED;
+
+	if (count == 0)
+		return ERROR_OK;
+
+	if (data && !nand->use_raw && nand->controller->read_pages) {
+		retval = nand->controller->read_pages(nand, page, count, data, oob, oob_size);
+		if (!nand_pages_fallback(retval))
+			return retval;
+	}
+
+	for (uint32_t i = 0; i < count; i++) {
+		retval = nand_read_page(nand, page + i,
+				data ? data + i * nand->page_size : NULL, data ? nand->page_size : 0,
+				oob ? oob + i * oob_size : NULL, oob_size);
+		if (retval != ERROR_OK)
+			return retval;
+	}
+
+	return ERROR_OK;
+}
+
 int nand_page_command(struct nand_device *nand, uint32_t page,
 	uint8_t cmd, bool oob_only)
 {
@@ -75,6 +75,17 @@ struct nand_flash_controller {
 	int (*read_page)(struct nand_device *nand, uint32_t page, uint8_t *data, uint32_t data_size,
 			 uint8_t *oob, uint32_t oob_size);
 
+	/** Write @a count consecutive pages in one go; @a oob, if not NULL, holds
+	 * @a count spare areas of @a oob_size bytes. May return
+	 * ERROR_NAND_OPERATION_NOT_SUPPORTED or ERROR_NAND_NO_BUFFER to have the
+	 * pages written one by one. */
+	int (*write_pages)(struct nand_device *nand, uint32_t page, uint32_t count,
+			   uint8_t *data, uint8_t *oob, uint32_t oob_size);
+
+	/** Read @a count consecutive pages in one go, see write_pages. */
+	int (*read_pages)(struct nand_device *nand, uint32_t page, uint32_t count,
+			  uint8_t *data, uint8_t *oob, uint32_t oob_size);
+
 	/** Check if the NAND device is ready for more instructions with timeout. */
 	int (*nand_ready)(struct nand_device *nand, int timeout);
 };
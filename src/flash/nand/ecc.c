@@ -66,27 +66,43 @@ static const uint8_t nand_ecc_precalc_table[] = {
 
 /*
  * nand_calculate_ecc - Calculate 3-byte ECC for 256-byte block
+ *
+ * The block is processed a 32 bit word at a time: the byte index of a word's
+ * bytes is (word index << 2) + lane, so the upper six line parity bits come
+ * from the parity of whole words and the lower two from the byte lanes of
+ * all words XORed together.
  */
 int nand_calculate_ecc(struct nand_device *nand, const uint8_t *dat, uint8_t *ecc_code)
 {
-	uint8_t idx, reg1, reg2, reg3, tmp1, tmp2;
+	uint8_t reg1, reg2, reg3, tmp1, tmp2;
+	uint8_t lane[4], all_par;
+	uint32_t all, word;
 	int i;
 
-	/* Initialize variables */
-	reg1 = reg2 = reg3 = 0;
+	/* Build up line parity of the word index and the column sum */
+	reg3 = 0;
+	all = 0;
+	for (i = 0; i < 64; i++) {
+		word = le_to_h_u32(dat + 4 * i);
+		all ^= word;
+
+		word ^= word >> 16;
+		word ^= word >> 8;
+		if (nand_ecc_precalc_table[word & 0xff] & 0x40)
+			reg3 ^= (uint8_t) (i << 2);
+	}
+
+	/* Get CP0 - CP5 and the byte lane parities from the table */
+	for (i = 0; i < 4; i++)
+		lane[i] = (nand_ecc_precalc_table[(all >> (8 * i)) & 0xff] >> 6) & 1;
+	reg1 = nand_ecc_precalc_table[(all ^ (all >> 8) ^ (all >> 16) ^ (all >> 24)) & 0xff] & 0x3f;
 
-	/* Build up column parity */
-	for (i = 0; i < 256; i++) {
-		/* Get CP0 - CP5 from table */
-		idx = nand_ecc_precalc_table[*dat++];
-		reg1 ^= (idx & 0x3f);
+	reg3 |= (lane[1] ^ lane[3]) << 0;
+	reg3 |= (lane[2] ^ lane[3]) << 1;
 
-		/* All bit XOR = 1 ? */
-		if (idx & 0x40) {
-			reg3 ^= (uint8_t) i;
-			reg2 ^= ~((uint8_t) i);
-		}
-	}
+	/* reg2 is the same sum over the inverted byte index */
+	all_par = lane[0] ^ lane[1] ^ lane[2] ^ lane[3];
+	reg2 = all_par ? ~reg3 : reg3;
 
 	/* Create non-inverted ECC code from line parity */
 	tmp1  = (reg3 & 0x80) >> 0; /* B7 -> B7 */
@@ -189,6 +189,7 @@ COMMAND_HANDLER(handle_nand_erase_command)
 
 	retval = nand_erase(p, offset, offset + length - 1);
 	if (retval == ERROR_OK) {
+		nand_state_cache_update(p);
 		command_print(CMD_CTX, "erased blocks %lu to %lu "
 			"on NAND flash device #%s '%s'",
 			offset, offset + length - 1,
@@ -233,6 +234,7 @@ COMMAND_HANDLER(handle_nand_check_bad_blocks_command)
 
 	retval = nand_build_bbt(p, first, last);
 	if (retval == ERROR_OK) {
+		nand_state_cache_update(p);
 		command_print(CMD_CTX, "checked NAND flash device for bad blocks, "
 			"use \"nand info\" command to list blocks");
 	}
@@ -240,36 +242,84 @@ COMMAND_HANDLER(handle_nand_check_bad_blocks_command)
 	return retval;
 }
 
+/* pages handed to the controller at once by the write and dump commands */
+#define NAND_BATCH_PAGES 32
+
+struct nand_batch {
+	uint8_t *pages;
+	uint8_t *oobs;
+};
+
+static int nand_batch_alloc(struct nand_batch *b, struct nand_fileio_state *s)
+{
+	b->pages = s->page ? malloc(NAND_BATCH_PAGES * s->page_size) : NULL;
+	b->oobs = s->oob ? malloc(NAND_BATCH_PAGES * s->oob_size) : NULL;
+
+	if ((s->page && !b->pages) || (s->oob && !b->oobs)) {
+		free(b->pages);
+		free(b->oobs);
+		return ERROR_FAIL;
+	}
+	return ERROR_OK;
+}
+
+static void nand_batch_free(struct nand_batch *b)
+{
+	free(b->pages);
+	free(b->oobs);
+}
+
 COMMAND_HANDLER(handle_nand_write_command)
 {
 	struct nand_device *nand = NULL;
 	struct nand_fileio_state s;
+	struct nand_batch batch;
 	int retval = CALL_COMMAND_HANDLER(nand_fileio_parse_args,
 			&s, &nand, FILEIO_READ, false, true);
 	if (ERROR_OK != retval)
 		return retval;
 
+	if (nand_batch_alloc(&batch, &s) != ERROR_OK) {
+		command_print(CMD_CTX, "out of memory");
+		nand_fileio_cleanup(&s);
+		return ERROR_FAIL;
+	}
+
 	uint32_t total_bytes = s.size;
 	while (s.size > 0) {
-		int bytes_read = nand_fileio_read(nand, &s);
-		if (bytes_read <= 0) {
-			command_print(CMD_CTX, "error while reading file");
-			nand_fileio_cleanup(&s);
-			return ERROR_FAIL;
+		uint32_t n;
+
+		for (n = 0; n < NAND_BATCH_PAGES && s.size > 0; n++) {
+			int bytes_read = nand_fileio_read(nand, &s);
+			if (bytes_read <= 0) {
+				command_print(CMD_CTX, "error while reading file");
+				nand_batch_free(&batch);
+				nand_fileio_cleanup(&s);
+				return ERROR_FAIL;
+			}
+			s.size -= bytes_read;
+
+			if (batch.pages)
+				memcpy(batch.pages + n * s.page_size, s.page, s.page_size);
+			if (batch.oobs)
+				memcpy(batch.oobs + n * s.oob_size, s.oob, s.oob_size);
 		}
-		s.size -= bytes_read;
 
-		retval = nand_write_page(nand, s.address / nand->page_size,
-				s.page, s.page_size, s.oob, s.oob_size);
+		retval = nand_write_pages(nand, s.address / nand->page_size, n,
+				batch.pages, batch.oobs, s.oob_size);
 		if (ERROR_OK != retval) {
 			command_print(CMD_CTX, "failed writing file %s "
 				"to NAND flash %s at offset 0x%8.8" PRIx32,
 				CMD_ARGV[1], CMD_ARGV[0], s.address);
+			nand_state_cache_update(nand);
+			nand_batch_free(&batch);
 			nand_fileio_cleanup(&s);
 			return retval;
 		}
-		s.address += s.page_size;
+		s.address += n * nand->page_size;
 	}
+	nand_batch_free(&batch);
+	nand_state_cache_update(nand);
 
 	if (nand_fileio_finish(&s) == ERROR_OK) {
 		command_print(CMD_CTX, "wrote file %s to NAND flash %s up to "
@@ -344,30 +394,45 @@ COMMAND_HANDLER(handle_nand_dump_command)
 	size_t filesize;
 	struct nand_device *nand = NULL;
 	struct nand_fileio_state s;
+	struct nand_batch batch;
 	int retval = CALL_COMMAND_HANDLER(nand_fileio_parse_args,
 			&s, &nand, FILEIO_WRITE, true, false);
 	if (ERROR_OK != retval)
 		return retval;
 
+	if (nand_batch_alloc(&batch, &s) != ERROR_OK) {
+		command_print(CMD_CTX, "out of memory");
+		nand_fileio_cleanup(&s);
+		return ERROR_FAIL;
+	}
+
 	while (s.size > 0) {
 		size_t size_written;
-		retval = nand_read_page(nand, s.address / nand->page_size,
-				s.page, s.page_size, s.oob, s.oob_size);
+		uint32_t n = MIN(s.size / nand->page_size, NAND_BATCH_PAGES);
+
+		retval = nand_read_pages(nand, s.address / nand->page_size, n,
+				batch.pages, batch.oobs, s.oob_size);
 		if (ERROR_OK != retval) {
 			command_print(CMD_CTX, "reading NAND flash page failed");
+			nand_batch_free(&batch);
 			nand_fileio_cleanup(&s);
 			return retval;
 		}
 
-		if (NULL != s.page)
-			fileio_write(s.fileio, s.page_size, s.page, &size_written);
+		for (uint32_t i = 0; i < n; i++) {
+			if (NULL != batch.pages)
+				fileio_write(s.fileio, s.page_size, batch.pages + i * s.page_size,
+						&size_written);
 
-		if (NULL != s.oob)
-			fileio_write(s.fileio, s.oob_size, s.oob, &size_written);
+			if (NULL != batch.oobs)
+				fileio_write(s.fileio, s.oob_size, batch.oobs + i * s.oob_size,
+						&size_written);
+		}
 
-		s.size -= nand->page_size;
-		s.address += nand->page_size;
+		s.size -= n * nand->page_size;
+		s.address += n * nand->page_size;
 	}
+	nand_batch_free(&batch);
 
 	retval = fileio_size(s.fileio, &filesize);
 	if (retval != ERROR_OK)
@@ -1140,6 +1140,164 @@ static uint32_t cfi_command_val(struct flash_bank *bank, uint8_t cmd)
 	}
 }
 
+/* Programs whole write buffers (0xe8/0xd0 resp. 0x25/0x29) with a loader
+ * fed through the async flash algorithm fifo. Returns
+ * ERROR_TARGET_RESOURCE_NOT_AVAILABLE if the target or chip can't do this,
+ * so the caller can fall back to the other write methods. */
+static int cfi_armv7m_write_buffered(struct flash_bank *bank, const uint8_t *buffer,
+	uint32_t address, uint32_t count)
+{
+	struct cfi_flash_bank *cfi_info = bank->driver_priv;
+	struct target *target = bank->target;
+	struct armv7m_algorithm armv7m_algo;
+	struct working_area *write_algorithm;
+	struct working_area *fifo;
+	struct reg_param reg_params[6];
+	uint32_t params[10];
+	uint8_t params_buf[sizeof(params)];
+	uint32_t buffersize, fifo_size, params_offset;
+	const uint8_t *code;
+	size_t code_size;
+	int retval;
+
+	/* see contrib/loaders/flash/cfi/armv7m_cfi_intel_buf.s for src */
+	static const uint8_t armv7m_intel_buf_code[] = {
+#include "../../../contrib/loaders/flash/cfi/armv7m_cfi_intel_buf.inc"
+	};
+
+	/* see contrib/loaders/flash/cfi/armv7m_cfi_span_buf.s for src */
+	static const uint8_t armv7m_span_buf_code[] = {
+#include "../../../contrib/loaders/flash/cfi/armv7m_cfi_span_buf.inc"
+	};
+
+	if (!is_armv7m(target_to_armv7m(target)) || cfi_info->buf_write_timeout_typ == 0)
+		return ERROR_TARGET_RESOURCE_NOT_AVAILABLE;
+
+	if (bank->bus_width != 1 && bank->bus_width != 2 && bank->bus_width != 4)
+		return ERROR_TARGET_RESOURCE_NOT_AVAILABLE;
+
+	if (count == 0)
+		return ERROR_OK;
+
+	/* buffersize is (buffer size per chip) * (number of chips) */
+	buffersize = (1UL << cfi_info->max_buf_write_size) * (bank->bus_width / bank->chip_width);
+
+	params[0] = cfi_command_val(bank, cfi_info->pri_id == 2 ? 0x25 : 0xe8);
+	params[1] = cfi_command_val(bank, cfi_info->pri_id == 2 ? 0x29 : 0xd0);
+	params[2] = cfi_command_val(bank, 1);
+	params[3] = buffersize;
+	params[4] = cfi_command_val(bank, 0x80);
+	memset(&params[5], 0, sizeof(params) - 5 * sizeof(uint32_t));
+
+	if (cfi_info->pri_id == 2) {
+		struct cfi_spansion_pri_ext *pri_ext = cfi_info->pri_ext;
+
+		if (cfi_info->status_poll_mask & (1 << 5))
+			params[5] = cfi_command_val(bank, 0x20);
+		params[6] = flash_address(bank, 0, pri_ext->_unlock1);
+		params[7] = cfi_command_val(bank, 0xaa);
+		params[8] = flash_address(bank, 0, pri_ext->_unlock2);
+		params[9] = cfi_command_val(bank, 0x55);
+
+		code = armv7m_span_buf_code;
+		code_size = sizeof(armv7m_span_buf_code);
+	} else {
+		params[5] = cfi_command_val(bank, 0x7e);
+
+		code = armv7m_intel_buf_code;
+		code_size = sizeof(armv7m_intel_buf_code);
+	}
+
+	/* code and parameter block share one working area */
+	params_offset = (code_size + 3) & ~3;
+	if (target_alloc_working_area(target, params_offset + sizeof(params),
+			&write_algorithm) != ERROR_OK) {
+		LOG_WARNING("no working area available, can't do buffered writes");
+		return ERROR_TARGET_RESOURCE_NOT_AVAILABLE;
+	}
+
+	target_buffer_set_u32_array(target, params_buf, ARRAY_SIZE(params), params);
+
+	retval = target_write_buffer(target, write_algorithm->address, code_size, code);
+	if (retval == ERROR_OK)
+		retval = target_write_buffer(target, write_algorithm->address + params_offset,
+				sizeof(params_buf), params_buf);
+	if (retval != ERROR_OK) {
+		target_free_working_area(target, write_algorithm);
+		return retval;
+	}
+
+	/* the fifo has to hold a whole write buffer while the host adds more */
+	fifo_size = 16384;
+	while (target_alloc_working_area_try(target, fifo_size, &fifo) != ERROR_OK) {
+		fifo_size /= 2;
+		if (fifo_size < 2 * buffersize + 8) {
+			target_free_working_area(target, write_algorithm);
+			LOG_WARNING("no large enough working area available, can't do buffered writes");
+			return ERROR_TARGET_RESOURCE_NOT_AVAILABLE;
+		}
+	}
+
+	if (cfi_info->pri_id != 2)
+		cfi_intel_clear_status_register(bank);
+
+	armv7m_algo.common_magic = ARMV7M_COMMON_MAGIC;
+	armv7m_algo.core_mode = ARM_MODE_THREAD;
+
+	init_reg_param(&reg_params[0], "r0", 32, PARAM_IN_OUT);	/* fifo start, status (out) */
+	init_reg_param(&reg_params[1], "r1", 32, PARAM_OUT);	/* fifo end */
+	init_reg_param(&reg_params[2], "r2", 32, PARAM_OUT);	/* flash address */
+	init_reg_param(&reg_params[3], "r3", 32, PARAM_OUT);	/* bus words */
+	init_reg_param(&reg_params[4], "r4", 32, PARAM_OUT);	/* parameter block */
+	init_reg_param(&reg_params[5], "r5", 32, PARAM_OUT);	/* bus width */
+
+	buf_set_u32(reg_params[0].value, 0, 32, fifo->address);
+	buf_set_u32(reg_params[1].value, 0, 32, fifo->address + fifo_size);
+	buf_set_u32(reg_params[2].value, 0, 32, address);
+	buf_set_u32(reg_params[3].value, 0, 32, count / bank->bus_width);
+	buf_set_u32(reg_params[4].value, 0, 32, write_algorithm->address + params_offset);
+	buf_set_u32(reg_params[5].value, 0, 32, bank->bus_width);
+
+	LOG_DEBUG("buffered write of 0x%" PRIx32 " bytes at 0x%08" PRIx32
+		", write buffer 0x%" PRIx32 ", fifo 0x%" PRIx32,
+		count, address, buffersize, fifo_size);
+
+	retval = target_run_flash_async_algorithm(target, buffer, count / bank->bus_width,
+			bank->bus_width, 0, NULL, ARRAY_SIZE(reg_params), reg_params,
+			fifo->address, fifo_size,
+			write_algorithm->address, write_algorithm->address + code_size - 2,
+			&armv7m_algo);
+
+	if (retval == ERROR_FLASH_OPERATION_FAILED) {
+		LOG_ERROR("buffered write failed, flash status 0x%" PRIx32,
+			buf_get_u32(reg_params[0].value, 0, 32));
+		if (cfi_info->pri_id != 2) {
+			cfi_intel_clear_status_register(bank);
+			cfi_send_command(bank, 0xff, flash_address(bank, 0, 0x0));
+		} else {
+			struct cfi_spansion_pri_ext *pri_ext = cfi_info->pri_ext;
+
+			/* an aborted write buffer program needs the
+			 * write-to-buffer-abort reset, a plain 0xf0 is ignored */
+			cfi_send_command(bank, 0xaa, flash_address(bank, 0, pri_ext->_unlock1));
+			cfi_send_command(bank, 0x55, flash_address(bank, 0, pri_ext->_unlock2));
+			cfi_send_command(bank, 0xf0, flash_address(bank, 0, pri_ext->_unlock1));
+		}
+	}
+
+	target_free_working_area(target, fifo);
+	target_free_working_area(target, write_algorithm);
+
+	destroy_reg_param(&reg_params[0]);
+	destroy_reg_param(&reg_params[1]);
+	destroy_reg_param(&reg_params[2]);
+	destroy_reg_param(&reg_params[3]);
+	destroy_reg_param(&reg_params[4]);
+	destroy_reg_param(&reg_params[5]);
+
+	return retval;
+}
+
 static int cfi_intel_write_block(struct flash_bank *bank, const uint8_t *buffer,
 	uint32_t address, uint32_t count)
 {
@@ -2396,13 +2554,17 @@ static int cfi_write(struct flash_bank *bank, const uint8_t *buffer, uint32_t of
 	/* handle blocks of bus_size aligned bytes */
 	blk_count = count & ~(bank->bus_width - 1);	/* round down, leave tail bytes */
 	switch (cfi_info->pri_id) {
-		/* try block writes (fails without working area) */
+		/* try buffered or block writes (fails without working area) */
 		case 1:
 		case 3:
-			retval = cfi_intel_write_block(bank, buffer, write_p, blk_count);
+			retval = cfi_armv7m_write_buffered(bank, buffer, write_p, blk_count);
+			if (retval == ERROR_TARGET_RESOURCE_NOT_AVAILABLE)
+				retval = cfi_intel_write_block(bank, buffer, write_p, blk_count);
 			break;
 		case 2:
-			retval = cfi_spansion_write_block(bank, buffer, write_p, blk_count);
+			retval = cfi_armv7m_write_buffered(bank, buffer, write_p, blk_count);
+			if (retval == ERROR_TARGET_RESOURCE_NOT_AVAILABLE)
+				retval = cfi_spansion_write_block(bank, buffer, write_p, blk_count);
 			break;
 		default:
 			LOG_ERROR("cfi primary command set %i unsupported", cfi_info->pri_id);
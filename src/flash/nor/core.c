@@ -37,10 +37,114 @@
 
 static struct flash_bank *flash_banks;
 
+/* number of bytes at the start of a bank whose CRC fingerprints its contents */
+#define FLASH_STATE_CACHE_FINGERPRINT_SIZE 4096
+
+static bool flash_bank_state_cacheable(struct flash_bank *bank)
+{
+	/* virtual banks share the sectors of their master bank */
+	return flash_state_cache_get_dir() && bank->num_sectors > 0
+		&& strcmp(bank->driver->name, "virtual") != 0;
+}
+
+static void flash_bank_state_cache_key(struct flash_bank *bank,
+	char *key, size_t size)
+{
+	/* bank and target name keep banks at the same base address on
+	 * different targets apart */
+	snprintf(key, size, "flash-%s-%s-%s-%08" PRIx32 "-%" PRIx32 "-%d",
+		bank->name, target_name(bank->target), bank->driver->name,
+		bank->base, bank->size, bank->num_sectors);
+}
+
+static int flash_bank_state_cache_fingerprint(struct flash_bank *bank,
+	uint32_t *fingerprint)
+{
+	uint32_t size = MIN(bank->size, FLASH_STATE_CACHE_FINGERPRINT_SIZE);
+	uint8_t *buffer = malloc(size);
+	if (!buffer)
+		return ERROR_FAIL;
+
+	int retval = bank->driver->read(bank, buffer, 0, size);
+	if (retval == ERROR_OK)
+		retval = image_calculate_checksum(buffer, size, fingerprint);
+	free(buffer);
+	return retval;
+}
+
+/* restore sector erase states from the state cache, once per bank */
+static void flash_bank_state_cache_restore(struct flash_bank *bank)
+{
+	if (bank->state_cache_checked || !flash_bank_state_cacheable(bank))
+		return;
+	bank->state_cache_checked = true;
+
+	uint32_t fingerprint;
+	if (flash_bank_state_cache_fingerprint(bank, &fingerprint) != ERROR_OK)
+		return;
+
+	int8_t *states = malloc(bank->num_sectors);
+	if (!states)
+		return;
+
+	char key[160];
+	flash_bank_state_cache_key(bank, key, sizeof(key));
+	if (flash_state_cache_load(key, fingerprint, states,
+			bank->num_sectors) == ERROR_OK) {
+		for (int i = 0; i < bank->num_sectors; i++)
+			bank->sectors[i].is_erased = states[i];
+		bank->state_cache_valid = true;
+		LOG_INFO("restored erase state of flash bank %s from state cache",
+			bank->name);
+	}
+	free(states);
+}
+
+static void flash_bank_state_cache_invalidate(struct flash_bank *bank)
+{
+	if (!bank->state_cache_valid)
+		return;
+
+	char key[160];
+	flash_bank_state_cache_key(bank, key, sizeof(key));
+	flash_state_cache_drop(key);
+	bank->state_cache_valid = false;
+}
+
+int flash_bank_state_cache_update(struct flash_bank *bank)
+{
+	if (!flash_bank_state_cacheable(bank))
+		return ERROR_OK;
+
+	uint32_t fingerprint;
+	int retval = flash_bank_state_cache_fingerprint(bank, &fingerprint);
+	if (retval != ERROR_OK)
+		return retval;
+
+	int8_t *states = malloc(bank->num_sectors);
+	if (!states)
+		return ERROR_FAIL;
+
+	for (int i = 0; i < bank->num_sectors; i++)
+		states[i] = bank->sectors[i].is_erased;
+
+	char key[160];
+	flash_bank_state_cache_key(bank, key, sizeof(key));
+	retval = flash_state_cache_store(key, fingerprint, states,
+			bank->num_sectors);
+	free(states);
+
+	bank->state_cache_checked = true;
+	bank->state_cache_valid = (retval == ERROR_OK);
+	return retval;
+}
+
 int flash_driver_erase(struct flash_bank *bank, int first, int last)
 {
 	int retval;
 
+	flash_bank_state_cache_invalidate(bank);
+
 	retval = bank->driver->erase(bank, first, last);
 	if (retval != ERROR_OK)
 		LOG_ERROR("failed erasing sectors %d to %d", first, last);
@@ -91,6 +195,8 @@ int flash_driver_write(struct flash_bank *bank,
 {
 	int retval;
 
+	flash_bank_state_cache_invalidate(bank);
+
 	retval = bank->driver->write(bank, buffer, offset, count);
 	if (retval != ERROR_OK) {
 		LOG_ERROR(
@@ -99,6 +205,14 @@ int flash_driver_write(struct flash_bank *bank,
 			offset);
 	}
 
+	/* the written sectors no longer are blank, whatever the outcome */
+	for (int i = 0; i < bank->num_sectors; i++) {
+		struct flash_sector *sector = &bank->sectors[i];
+		if (sector->offset < offset + count
+				&& sector->offset + sector->size > offset)
+			sector->is_erased = 0;
+	}
+
 	return retval;
 }
 
@@ -236,6 +350,7 @@ int get_flash_bank_by_name(const char *name, struct flash_bank **bank_result)
 			LOG_ERROR("auto_probe failed");
 			return retval;
 		}
+		flash_bank_state_cache_restore(bank);
 	}
 
 	*bank_result = bank;
@@ -256,6 +371,7 @@ int get_flash_bank_by_num(int num, struct flash_bank **bank)
 		LOG_ERROR("auto_probe failed");
 		return retval;
 	}
+	flash_bank_state_cache_restore(p);
 	*bank = p;
 	return ERROR_OK;
 }
@@ -283,6 +399,7 @@ int get_flash_bank_by_addr(struct target *target,
 		}
 		/* check whether address belongs to this flash bank */
 		if ((addr >= c->base) && (addr <= c->base + (c->size - 1))) {
+			flash_bank_state_cache_restore(c);
 			*result_bank = c;
 			return ERROR_OK;
 		}
@@ -298,9 +415,8 @@ int get_flash_bank_by_addr(struct target *target,
 static int default_flash_mem_blank_check(struct flash_bank *bank)
 {
 	struct target *target = bank->target;
-	const int buffer_size = 1024;
+	const uint32_t buffer_size = 32 * 1024;
 	int i;
-	uint32_t nBytes;
 	int retval = ERROR_OK;
 
 	if (bank->target->state != TARGET_HALTED) {
@@ -309,35 +425,41 @@ static int default_flash_mem_blank_check(struct flash_bank *bank)
 	}
 
 	uint8_t *buffer = malloc(buffer_size);
+	uint8_t *erased = malloc(buffer_size);
+	if (buffer == NULL || erased == NULL) {
+		LOG_ERROR("Out of memory");
+		retval = ERROR_FAIL;
+		goto done;
+	}
+
+	/* compare whole chunks against an erased pattern, memcmp() is a lot
+	 * faster than checking byte by byte */
+	memset(erased, bank->erased_value, buffer_size);
 
 	for (i = 0; i < bank->num_sectors; i++) {
 		uint32_t j;
 		bank->sectors[i].is_erased = 1;
 
 		for (j = 0; j < bank->sectors[i].size; j += buffer_size) {
-			uint32_t chunk;
-			chunk = buffer_size;
-			if (chunk > (j - bank->sectors[i].size))
-				chunk = (j - bank->sectors[i].size);
+			uint32_t chunk = MIN(buffer_size, bank->sectors[i].size - j);
 
-			retval = target_read_memory(target,
+			retval = target_read_buffer(target,
 					bank->base + bank->sectors[i].offset + j,
-					4,
-					chunk/4,
-					buffer);
+					chunk, buffer);
 			if (retval != ERROR_OK)
 				goto done;
 
-			for (nBytes = 0; nBytes < chunk; nBytes++) {
-				if (buffer[nBytes] != bank->erased_value) {
-					bank->sectors[i].is_erased = 0;
-					break;
-				}
+			if (memcmp(buffer, erased, chunk) != 0) {
+				/* no need to read the rest of the sector */
+				bank->sectors[i].is_erased = 0;
+				break;
 			}
 		}
+		keep_alive();
 	}
 
 done:
+	free(erased);
 	free(buffer);
 
 	return retval;
@@ -689,10 +811,329 @@ static bool flash_write_check_gap(struct flash_bank *bank,
 	return aligned1 + bank->minimal_write_gap < aligned2;
 }
 
+/**
+ * Check whether @a count bytes of flash at @a offset already hold the
+ * contents of @a buffer. Memory mapped banks are compared by checksum,
+ * computed on the target where possible; other banks are read back.
+ */
+static int flash_range_unchanged(struct flash_bank *bank, uint8_t *buffer,
+		uint32_t offset, uint32_t count, bool *unchanged)
+{
+	int retval;
+
+	if (bank->driver->read == default_flash_read) {
+		uint32_t target_crc, image_crc;
+
+		retval = target_checksum_memory(bank->target, bank->base + offset,
+				count, &target_crc);
+		if (retval != ERROR_OK)
+			return retval;
+
+		retval = image_calculate_checksum(buffer, count, &image_crc);
+		if (retval != ERROR_OK)
+			return retval;
+
+		*unchanged = (target_crc == image_crc);
+		return ERROR_OK;
+	}
+
+	uint8_t *current = malloc(count);
+	if (current == NULL) {
+		LOG_ERROR("Out of memory");
+		return ERROR_FAIL;
+	}
+
+	retval = flash_driver_read(bank, current, offset, count);
+	if (retval == ERROR_OK)
+		*unchanged = (memcmp(current, buffer, count) == 0);
+
+	free(current);
+	return retval;
+}
+
+/**
+ * Unlock, erase and program the parts of a run of @a run_size bytes at
+ * @a run_address whose flash sectors differ from @a buffer. Sectors that
+ * already hold the right contents are left alone and accounted in
+ * @a skipped; adjacent changed sectors are programmed in one go.
+ */
+static int flash_write_run_delta(struct target *target, struct flash_bank *bank,
+		uint8_t *buffer, target_addr_t run_address, uint32_t run_size,
+		int erase, bool unlock, uint32_t *skipped)
+{
+	uint32_t run_offset = run_address - bank->base;
+	uint32_t run_end = run_offset + run_size;
+	uint32_t pending_start = 0, pending_end = 0;
+	struct target_memory_check_block *blocks = NULL;
+	int first = 0, last = -1;
+	bool unchanged;
+	int retval;
 
-int flash_write_unlock(struct target *target, struct image *image,
-	uint32_t *written, int erase, bool unlock)
+	/* an identical run costs a single checksum */
+	retval = flash_range_unchanged(bank, buffer, run_offset, run_size, &unchanged);
+	if (retval != ERROR_OK)
+		return retval;
+	if (unchanged) {
+		LOG_DEBUG("flash run at " TARGET_ADDR_FMT " unchanged", run_address);
+		*skipped += run_size;
+		return ERROR_OK;
+	}
+
+	if (bank->num_sectors == 0) {
+		/* without a sector layout the run can only be written as a whole */
+		retval = ERROR_OK;
+		if (unlock)
+			retval = flash_unlock_address_range(target, run_address, run_size);
+		if (retval == ERROR_OK && erase)
+			retval = flash_erase_address_range(target, true, run_address, run_size);
+		if (retval == ERROR_OK)
+			retval = flash_driver_write(bank, buffer, run_offset, run_size);
+		return retval;
+	}
+
+	/* find the sectors of the run */
+	for (int sector = 0; sector < bank->num_sectors; sector++) {
+		uint32_t sector_end = bank->sectors[sector].offset + bank->sectors[sector].size;
+		if (sector_end <= run_offset)
+			first = sector + 1;
+		if (bank->sectors[sector].offset < run_end)
+			last = sector;
+	}
+
+	/* checksum all of them in one go where the flash is memory mapped */
+	if (bank->driver->read == default_flash_read && last >= first) {
+		blocks = calloc(last - first + 1, sizeof(*blocks));
+		if (blocks == NULL) {
+			LOG_ERROR("Out of memory");
+			return ERROR_FAIL;
+		}
+
+		for (int sector = first; sector <= last; sector++) {
+			uint32_t start = MAX(bank->sectors[sector].offset, run_offset);
+			uint32_t end = MIN(bank->sectors[sector].offset + bank->sectors[sector].size, run_end);
+			blocks[sector - first].address = bank->base + start;
+			blocks[sector - first].size = end - start;
+		}
+
+		retval = target_checksum_memory_blocks(target, blocks, last - first + 1);
+		if (retval != ERROR_OK)
+			goto done;
+	}
+
+	for (int sector = first; sector <= last + 1; sector++) {
+		uint32_t start = run_end, end = run_end;
+
+		if (sector <= last) {
+			start = MAX(bank->sectors[sector].offset, run_offset);
+			end = MIN(bank->sectors[sector].offset + bank->sectors[sector].size, run_end);
+
+			if (blocks) {
+				uint32_t image_crc;
+				retval = image_calculate_checksum(buffer + start - run_offset,
+						end - start, &image_crc);
+				unchanged = (image_crc == blocks[sector - first].result);
+			} else
+				retval = flash_range_unchanged(bank, buffer + start - run_offset,
+						start, end - start, &unchanged);
+			if (retval != ERROR_OK)
+				goto done;
+
+			if (!unchanged) {
+				if (pending_end != start)
+					pending_start = start;
+				pending_end = end;
+				continue;
+			}
+
+			LOG_DEBUG("flash sector %d unchanged, skipped", sector);
+			*skipped += end - start;
+		}
+
+		/* program the changed sectors collected so far */
+		if (pending_end > pending_start) {
+			uint32_t count = pending_end - pending_start;
+
+			retval = ERROR_OK;
+			if (unlock)
+				retval = flash_unlock_address_range(target,
+						bank->base + pending_start, count);
+			if (retval == ERROR_OK && erase)
+				retval = flash_erase_address_range(target, true,
+						bank->base + pending_start, count);
+			if (retval == ERROR_OK)
+				retval = flash_driver_write(bank, buffer + pending_start - run_offset,
+						pending_start, count);
+			if (retval != ERROR_OK)
+				goto done;
+		}
+		pending_start = pending_end = 0;
+	}
+
+	retval = ERROR_OK;
+
+done:
+	free(blocks);
+	return retval;
+}
+
+/* An erase running in one bank while another bank is being programmed */
+struct flash_async_erase {
+	struct flash_bank *bank;	/* NULL if none */
+	target_addr_t start, end;	/* sector aligned range being erased */
+	bool done;
+};
+
+static int flash_async_erase_wait(struct flash_async_erase *async)
+{
+	int retval = ERROR_OK;
+
+	while (!async->done) {
+		retval = async->bank->driver->erase_poll(async->bank, &async->done);
+		if (retval != ERROR_OK || async->done)
+			break;
+		alive_sleep(1);
+	}
+
+	if (retval != ERROR_OK)
+		async->bank = NULL;
+	return retval;
+}
+
+/**
+ * Start erasing the sectors of the image data at @a address in the
+ * background, if that data is in a bank other than @a current whose driver
+ * supports it. Only the sectors the data touches are erased, the same ones
+ * a synchronous erase of the run starting there would cover.
+ */
+static void flash_async_erase_start(struct target *target, struct flash_bank *current,
+		target_addr_t address, uint32_t size, bool unlock,
+		struct flash_async_erase *async)
+{
+	struct flash_bank *bank;
+	int first = -1, last = -1;
+
+	if (get_flash_bank_by_addr(target, address, false, &bank) != ERROR_OK || !bank)
+		return;
+	if (bank == current || !bank->driver->erase_start || !bank->driver->erase_poll)
+		return;
+
+	uint32_t offset = address - bank->base;
+	uint32_t end = MIN(offset + size, bank->size);
+	for (int sector = 0; sector < bank->num_sectors; sector++) {
+		uint32_t sector_end = bank->sectors[sector].offset + bank->sectors[sector].size;
+		if (sector_end <= offset || bank->sectors[sector].offset >= end)
+			continue;
+		if (first < 0)
+			first = sector;
+		last = sector;
+	}
+	if (first < 0)
+		return;
+
+	async->start = bank->base + bank->sectors[first].offset;
+	async->end = bank->base + bank->sectors[last].offset + bank->sectors[last].size;
+
+	if (unlock && flash_unlock_address_range(target, async->start,
+			async->end - async->start) != ERROR_OK)
+		return;
+
+	flash_bank_state_cache_invalidate(bank);
+
+	if (bank->driver->erase_start(bank, first, last) != ERROR_OK) {
+		LOG_DEBUG("could not start erasing sectors %d..%d of %s in background",
+			first, last, bank->name);
+		return;
+	}
+
+	LOG_DEBUG("erasing sectors %d..%d of %s in background", first, last, bank->name);
+	async->bank = bank;
+	async->done = false;
+}
+
+/**
+ * Erase the sectors of a run, taking into account sectors of the bank
+ * which have been erased in the background.
+ */
+static int flash_erase_run(struct target *target, struct flash_bank *bank,
+		target_addr_t run_address, uint32_t run_size,
+		struct flash_async_erase *async)
+{
+	target_addr_t run_end = run_address + run_size;
+	int retval;
+
+	if (async->bank != bank)
+		return flash_erase_address_range(target, true, run_address, run_size);
+
+	/* the bank can't do anything else until the background erase is done */
+	retval = flash_async_erase_wait(async);
+	async->bank = NULL;
+	if (retval != ERROR_OK)
+		return retval;
+
+	if (async->end <= run_address || async->start >= run_end)
+		return flash_erase_address_range(target, true, run_address, run_size);
+
+	/* the background erase covered the sectors of the first section of the
+	 * run, erase whatever the rest of the run needs */
+	if (run_address < async->start)
+		retval = flash_erase_address_range(target, true, run_address,
+				async->start - run_address);
+	if (retval == ERROR_OK && run_end > async->end)
+		retval = flash_erase_address_range(target, true, async->end,
+				run_end - async->end);
+
+	return retval;
+}
+
+/**
+ * Program a run into @a bank. While another bank is erasing in the
+ * background, the run is written a sector at a time and the erase is
+ * polled in between, so that its next sector can be started as soon as
+ * the previous one is done.
+ */
+static int flash_write_run(struct flash_bank *bank, uint8_t *buffer,
+		uint32_t offset, uint32_t count, struct flash_async_erase *async)
 {
+	int retval;
+
+	while (count > 0) {
+		uint32_t chunk = count;
+
+		if (async->bank && !async->done) {
+			for (int sector = 0; sector < bank->num_sectors; sector++) {
+				struct flash_sector *f = &bank->sectors[sector];
+				if (offset >= f->offset && offset - f->offset < f->size) {
+					chunk = MIN(count, f->offset + f->size - offset);
+					break;
+				}
+			}
+		}
+
+		retval = flash_driver_write(bank, buffer, offset, chunk);
+		if (retval != ERROR_OK)
+			return retval;
+
+		buffer += chunk;
+		offset += chunk;
+		count -= chunk;
+
+		if (async->bank && !async->done) {
+			retval = async->bank->driver->erase_poll(async->bank, &async->done);
+			if (retval != ERROR_OK) {
+				/* flash_erase_run() erases that bank synchronously */
+				LOG_WARNING("background erase of %s failed", async->bank->name);
+				async->bank = NULL;
+			}
+		}
+	}
+
+	return ERROR_OK;
+}
+
+static int flash_write_image(struct target *target, struct image *image,
+	uint32_t *written, uint32_t *skipped, int erase, bool unlock, bool skip_unchanged)
+{
+	struct flash_async_erase async = { .bank = NULL };
 	int retval = ERROR_OK;
 
 	int section;
@@ -705,6 +1146,8 @@ int flash_write_unlock(struct target *target, struct image *image,
 
 	if (written)
 		*written = 0;
+	if (skipped)
+		*skipped = 0;
 
 	if (erase) {
 		/* assume all sectors need erasing - stops any problems
@@ -914,20 +1357,34 @@ int flash_write_unlock(struct target *target, struct image *image,
 		}
 
 		retval = ERROR_OK;
+		uint32_t run_skipped = 0;
+
+		if (skip_unchanged) {
+			retval = flash_write_run_delta(target, c, buffer, run_address, run_size,
+					erase, unlock, &run_skipped);
+		} else {
+			if (unlock)
+				retval = flash_unlock_address_range(target, run_address, run_size);
+			if (retval == ERROR_OK) {
+				if (erase) {
+					/* calculate and erase sectors */
+					retval = flash_erase_run(target, c, run_address, run_size, &async);
+				}
+			}
 
-		if (unlock)
-			retval = flash_unlock_address_range(target, run_address, run_size);
-		if (retval == ERROR_OK) {
-			if (erase) {
-				/* calculate and erase sectors */
-				retval = flash_erase_address_range(target,
-						true, run_address, run_size);
+			/* while this run is programmed, erase the next one if it
+			 * is in another bank */
+			if (retval == ERROR_OK && erase && !async.bank &&
+					section < image->num_sections) {
+				flash_async_erase_start(target, c,
+						sections[section]->base_address + section_offset,
+						sections[section]->size - section_offset, unlock, &async);
 			}
-		}
 
-		if (retval == ERROR_OK) {
-			/* write flash sectors */
-			retval = flash_driver_write(c, buffer, run_address - c->base, run_size);
+			if (retval == ERROR_OK) {
+				/* write flash sectors */
+				retval = flash_write_run(c, buffer, run_address - c->base, run_size, &async);
+			}
 		}
 
 		free(buffer);
@@ -938,16 +1395,37 @@ int flash_write_unlock(struct target *target, struct image *image,
 		}
 
 		if (written != NULL)
-			*written += run_size;	/* add run size to total written counter */
+			*written += run_size - run_skipped;	/* add run size to total written counter */
+		if (skipped != NULL)
+			*skipped += run_skipped;
 	}
 
 done:
+	/* don't leave a bank erasing in the background */
+	if (async.bank) {
+		struct flash_bank *bank = async.bank;
+		if (flash_async_erase_wait(&async) != ERROR_OK)
+			LOG_ERROR("background erase of %s failed", bank->name);
+	}
+
 	free(sections);
 	free(padding);
 
 	return retval;
 }
 
+int flash_write_unlock(struct target *target, struct image *image,
+	uint32_t *written, int erase, bool unlock)
+{
+	return flash_write_image(target, image, written, NULL, erase, unlock, false);
+}
+
+int flash_write_delta(struct target *target, struct image *image,
+	uint32_t *written, uint32_t *skipped, int erase, bool unlock)
+{
+	return flash_write_image(target, image, written, skipped, erase, unlock, true);
+}
+
 int flash_write(struct target *target, struct image *image,
 	uint32_t *written, int erase)
 {
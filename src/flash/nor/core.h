@@ -135,6 +135,11 @@ struct flash_bank {
 	/** Array of protection blocks, allocated and initilized by the flash driver */
 	struct flash_sector *prot_blocks;
 
+	/** Sector states have been looked up in the on-disk state cache. */
+	bool state_cache_checked;
+	/** The on-disk state cache entry matches the current sector states. */
+	bool state_cache_valid;
+
 	struct flash_bank *next; /**< The next flash bank on this chip */
 };
 
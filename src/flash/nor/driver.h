@@ -106,6 +106,33 @@ struct flash_driver {
 	 */
 	int (*erase)(struct flash_bank *bank, int first, int last);
 
+	/**
+	 * Optional: start erasing sectors @a first to @a last without
+	 * waiting for the erase to finish. The erase is then driven to
+	 * completion by calling erase_poll() until it reports done; no other
+	 * operation is issued on this bank meanwhile. The flash core uses
+	 * this to erase one bank while programming another one, so it is
+	 * only worth implementing for banks with their own flash controller.
+	 *
+	 * @param bank The bank of flash to be erased.
+	 * @param first The number of the first sector to erase.
+	 * @param last The number of the last sector to erase.
+	 * @returns ERROR_OK if the erase was started; otherwise, an error code.
+	 */
+	int (*erase_start)(struct flash_bank *bank, int first, int last);
+
+	/**
+	 * Checks the progress of an erase started by erase_start() without
+	 * blocking, starting the next sector if the hardware needs it.
+	 * Required if erase_start() is implemented.
+	 *
+	 * @param bank The bank being erased.
+	 * @param done Set to true once all sectors are erased.
+	 * @returns ERROR_OK if successful; otherwise, an error code, which
+	 * also ends the erase.
+	 */
+	int (*erase_poll)(struct flash_bank *bank, bool *done);
+
 	/**
 	 * Bank/sector protection routine (target-specific).
 	 *
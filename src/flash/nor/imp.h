@@ -42,8 +42,18 @@ int flash_driver_write(struct flash_bank *bank,
 int flash_driver_read(struct flash_bank *bank,
 		uint8_t *buffer, uint32_t offset, uint32_t count);
 
+/**
+ * Stores the sector erase states of @a bank in the on-disk state cache,
+ * if one is configured.  Erases and writes drop the entry again.
+ */
+int flash_bank_state_cache_update(struct flash_bank *bank);
+
 /* write (optional verify) an image to flash memory of the given target */
 int flash_write_unlock(struct target *target, struct image *image,
 		uint32_t *written, int erase, bool unlock);
+/* like flash_write_unlock(), but leave flash sectors which already hold
+ * the image contents untouched; @a skipped counts the bytes left alone */
+int flash_write_delta(struct target *target, struct image *image,
+		uint32_t *written, uint32_t *skipped, int erase, bool unlock);
 
 #endif /* OPENOCD_FLASH_NOR_IMP_H */
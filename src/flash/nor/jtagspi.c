@@ -26,12 +26,21 @@
 
 #define JTAGSPI_MAX_TIMEOUT 3000
 
+/* Bulk writes queue this many pages at once, waiting a fixed time after each
+ * page program instead of polling the status register, and verify the data
+ * at the end. The wait starts at a typical datasheet page program time and
+ * is doubled whenever a bulk write fails to verify; beyond the maximum, pages
+ * are written one at a time with polling. */
+#define JTAGSPI_BULK_PAGES 64
+#define JTAGSPI_PAGE_PROGRAM_US 1000
+#define JTAGSPI_PAGE_PROGRAM_MAX_US 8000
 
 struct jtagspi_flash_bank {
 	struct jtag_tap *tap;
 	const struct flash_device *dev;
 	int probed;
 	uint32_t ir;
+	uint32_t page_program_us;
 };
 
 FLASH_BANK_COMMAND_HANDLER(jtagspi_flash_bank_command)
@@ -50,6 +59,7 @@ FLASH_BANK_COMMAND_HANDLER(jtagspi_flash_bank_command)
 
 	info->tap = NULL;
 	info->probed = 0;
+	info->page_program_us = JTAGSPI_PAGE_PROGRAM_US;
 	COMMAND_PARSE_NUMBER(u32, CMD_ARGV[6], info->ir);
 
 	return ERROR_OK;
@@ -75,8 +85,10 @@ static void flip_u8(uint8_t *in, uint8_t *out, int len)
 		out[i] = flip_u32(in[i], 8);
 }
 
-static int jtagspi_cmd(struct flash_bank *bank, uint8_t cmd,
-		uint32_t *addr, uint8_t *data, int len)
+/* Queues an SPI transaction; writes are only executed if @a execute is set,
+ * so several of them can be sent in one go. */
+static int jtagspi_xfer(struct flash_bank *bank, uint8_t cmd,
+		uint32_t *addr, uint8_t *data, int len, bool execute)
 {
 	struct jtagspi_flash_bank *info = bank->driver_priv;
 	struct scan_field fields[6];
@@ -153,7 +165,8 @@ static int jtagspi_cmd(struct flash_bank *bank, uint8_t cmd,
 	jtagspi_set_ir(bank);
 	/* passing from an IR scan to SHIFT-DR clears BYPASS registers */
 	jtag_add_dr_scan(info->tap, n, fields, TAP_IDLE);
-	jtag_execute_queue();
+	if (execute || is_read)
+		jtag_execute_queue();
 
 	if (is_read)
 		flip_u8(data_buf, data, lenb);
@@ -161,6 +174,12 @@ static int jtagspi_cmd(struct flash_bank *bank, uint8_t cmd,
 	return ERROR_OK;
 }
 
+static int jtagspi_cmd(struct flash_bank *bank, uint8_t cmd,
+		uint32_t *addr, uint8_t *data, int len)
+{
+	return jtagspi_xfer(bank, cmd, addr, data, len, true);
+}
+
 static int jtagspi_probe(struct flash_bank *bank)
 {
 	struct jtagspi_flash_bank *info = bank->driver_priv;
@@ -382,25 +401,98 @@ static int jtagspi_page_write(struct flash_bank *bank, const uint8_t *buffer, ui
 	return jtagspi_wait(bank, JTAGSPI_MAX_TIMEOUT);
 }
 
+/* bytes from @a offset up to the end of its page */
+static uint32_t jtagspi_page_remain(struct flash_bank *bank, uint32_t offset, uint32_t count)
+{
+	struct jtagspi_flash_bank *info = bank->driver_priv;
+
+	return MIN(count, info->dev->pagesize - offset % info->dev->pagesize);
+}
+
+/* Programs up to JTAGSPI_BULK_PAGES pages in a single JTAG queue, then
+ * reads them back. Returns ERROR_FLASH_OPERATION_FAILED if they don't
+ * match, which mostly means the flash was still busy when the next page
+ * was sent. */
+static int jtagspi_bulk_write(struct flash_bank *bank, const uint8_t *buffer, uint32_t offset, uint32_t count)
+{
+	struct jtagspi_flash_bank *info = bank->driver_priv;
+	uint8_t *readback;
+	uint32_t n, len;
+	int retval;
+
+	for (n = 0; n < count; n += len) {
+		uint32_t addr = offset + n;
+		len = jtagspi_page_remain(bank, addr, count - n);
+
+		jtagspi_xfer(bank, SPIFLASH_WRITE_ENABLE, NULL, NULL, 0, false);
+		retval = jtagspi_xfer(bank, SPIFLASH_PAGE_PROGRAM, &addr,
+				(uint8_t *)buffer + n, len * 8, false);
+		if (retval != ERROR_OK)
+			return retval;
+		jtag_add_sleep(info->page_program_us);
+	}
+
+	retval = jtag_execute_queue();
+	if (retval != ERROR_OK)
+		return retval;
+
+	retval = jtagspi_wait(bank, JTAGSPI_MAX_TIMEOUT);
+	if (retval != ERROR_OK)
+		return retval;
+
+	readback = malloc(count);
+	if (readback == NULL) {
+		LOG_ERROR("no memory for verify buffer");
+		return ERROR_FAIL;
+	}
+
+	retval = jtagspi_cmd(bank, SPIFLASH_READ, &offset, readback, -count * 8);
+	if (retval == ERROR_OK && memcmp(readback, buffer, count) != 0)
+		retval = ERROR_FLASH_OPERATION_FAILED;
+
+	free(readback);
+	return retval;
+}
+
 static int jtagspi_write(struct flash_bank *bank, const uint8_t *buffer, uint32_t offset, uint32_t count)
 {
 	struct jtagspi_flash_bank *info = bank->driver_priv;
 	int retval;
-	uint32_t n;
+	uint32_t n, chunk, len;
 
 	if (!(info->probed)) {
 		LOG_ERROR("Flash bank not yet probed.");
 		return ERROR_FLASH_BANK_NOT_PROBED;
 	}
 
-	for (n = 0; n < count; n += info->dev->pagesize) {
-		retval = jtagspi_page_write(bank, buffer + n, offset + n,
-				MIN(count - n, info->dev->pagesize));
-		if (retval != ERROR_OK) {
-			LOG_ERROR("page write error");
-			return retval;
+	for (n = 0; n < count; n += chunk) {
+		chunk = MIN(count - n, JTAGSPI_BULK_PAGES * info->dev->pagesize);
+
+		if (info->page_program_us <= JTAGSPI_PAGE_PROGRAM_MAX_US) {
+			retval = jtagspi_bulk_write(bank, buffer + n, offset + n, chunk);
+			if (retval == ERROR_OK) {
+				LOG_DEBUG("wrote %" PRIu32 " bytes at 0x%08" PRIx32, chunk, offset + n);
+				continue;
+			}
+			if (retval != ERROR_FLASH_OPERATION_FAILED)
+				return retval;
+
+			/* pages sent too early were ignored by the busy flash,
+			 * write them again the slow way */
+			info->page_program_us *= 2;
+			LOG_DEBUG("bulk write verify failed, page program wait now %" PRIu32 " us",
+				info->page_program_us);
+		}
+
+		for (uint32_t p = 0; p < chunk; p += len) {
+			len = jtagspi_page_remain(bank, offset + n + p, chunk - p);
+			retval = jtagspi_page_write(bank, buffer + n + p, offset + n + p, len);
+			if (retval != ERROR_OK) {
+				LOG_ERROR("page write error");
+				return retval;
+			}
+			LOG_DEBUG("wrote page at 0x%08" PRIx32, offset + n + p);
 		}
-		LOG_DEBUG("wrote page at 0x%08" PRIx32, offset + n);
 	}
 	return ERROR_OK;
 }
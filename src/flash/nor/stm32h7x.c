@@ -20,6 +20,7 @@
 
 #include "imp.h"
 #include <helper/binarybuffer.h>
+#include <helper/time_support.h>
 #include <target/algorithm.h>
 #include <target/armv7m.h>
 
@@ -133,6 +134,10 @@ struct stm32h7x_flash_bank {
 	uint32_t flash_base;    /* Address of flash reg controller */
 	struct stm32x_options option_bytes;
 	const struct stm32h7x_part_info *part_info;
+	/* asynchronous erase in progress, see stm32x_erase_start() */
+	int erase_sector;
+	int erase_last;
+	int64_t erase_sector_started;
 };
 
 static const struct stm32h7x_rev stm32_450_revs[] = {
@@ -512,6 +517,102 @@ static int stm32x_erase(struct flash_bank *bank, int first, int last)
 	return ERROR_OK;
 }
 
+static int stm32x_erase_sector_start(struct flash_bank *bank, int sector)
+{
+	struct target *target = bank->target;
+	struct stm32h7x_flash_bank *stm32x_info = bank->driver_priv;
+
+	LOG_DEBUG("erase sector %d", sector);
+	int retval = target_write_u32(target, stm32x_get_flash_reg(bank, FLASH_CR),
+			FLASH_SER | FLASH_SNB(sector) | FLASH_PSIZE_64);
+	if (retval == ERROR_OK)
+		retval = target_write_u32(target, stm32x_get_flash_reg(bank, FLASH_CR),
+				FLASH_SER | FLASH_SNB(sector) | FLASH_PSIZE_64 | FLASH_START);
+	if (retval != ERROR_OK) {
+		LOG_ERROR("Error erase sector %d", sector);
+		return retval;
+	}
+
+	stm32x_info->erase_sector = sector;
+	stm32x_info->erase_sector_started = timeval_ms();
+	return ERROR_OK;
+}
+
+/* Each bank has its own flash controller, so one bank can be erased while
+ * the other one is programmed. The sectors are erased one after the other,
+ * stm32x_erase_poll() starts the next one when the previous is done. */
+static int stm32x_erase_start(struct flash_bank *bank, int first, int last)
+{
+	struct stm32h7x_flash_bank *stm32x_info = bank->driver_priv;
+	int retval;
+
+	assert(first < bank->num_sectors);
+	assert(last < bank->num_sectors);
+
+	if (bank->target->state != TARGET_HALTED)
+		return ERROR_TARGET_NOT_HALTED;
+
+	retval = stm32x_unlock_reg(bank);
+	if (retval != ERROR_OK)
+		return retval;
+
+	stm32x_info->erase_last = last;
+	retval = stm32x_erase_sector_start(bank, first);
+	if (retval != ERROR_OK)
+		stm32x_lock_reg(bank);
+	return retval;
+}
+
+static int stm32x_erase_poll(struct flash_bank *bank, bool *done)
+{
+	struct stm32h7x_flash_bank *stm32x_info = bank->driver_priv;
+	uint32_t status;
+
+	*done = false;
+
+	int retval = stm32x_get_flash_status(bank, &status);
+	if (retval != ERROR_OK)
+		goto flash_lock;
+
+	if (status & FLASH_BSY) {
+		if (timeval_ms() - stm32x_info->erase_sector_started > FLASH_ERASE_TIMEOUT) {
+			LOG_ERROR("erase time-out sector %d", stm32x_info->erase_sector);
+			retval = ERROR_FAIL;
+			goto flash_lock;
+		}
+		return ERROR_OK;
+	}
+
+	/* reports and clears errors */
+	retval = stm32x_wait_status_busy(bank, 0);
+	if (retval != ERROR_OK) {
+		LOG_ERROR("erase operation error sector %d", stm32x_info->erase_sector);
+		goto flash_lock;
+	}
+	bank->sectors[stm32x_info->erase_sector].is_erased = 1;
+
+	if (stm32x_info->erase_sector < stm32x_info->erase_last) {
+		retval = stm32x_erase_sector_start(bank, stm32x_info->erase_sector + 1);
+		if (retval != ERROR_OK)
+			goto flash_lock;
+		return ERROR_OK;
+	}
+
+	retval = stm32x_lock_reg(bank);
+	if (retval != ERROR_OK) {
+		LOG_ERROR("error during the lock of flash");
+		return retval;
+	}
+
+	*done = true;
+	return ERROR_OK;
+
+flash_lock:
+	/* the erase is over, don't leave FLASH_CR unlocked */
+	stm32x_lock_reg(bank);
+	return retval;
+}
+
 static int stm32x_protect(struct flash_bank *bank, int set, int first, int last)
 {
 	struct target *target = bank->target;
@@ -1133,6 +1234,8 @@ struct flash_driver stm32h7x_flash = {
 	.commands = stm32x_command_handlers,
 	.flash_bank_command = stm32x_flash_bank_command,
 	.erase = stm32x_erase,
+	.erase_start = stm32x_erase_start,
+	.erase_poll = stm32x_erase_poll,
 	.protect = stm32x_protect,
 	.write = stm32x_write,
 	.read = default_flash_read,
@@ -24,6 +24,10 @@
 #include "imp.h"
 #include <helper/time_support.h>
 #include <target/image.h>
+#include <target/arm.h>
+#include <target/arm_adi_v5.h>
+#include <target/register.h>
+#include <transport/transport.h>
 
 /**
  * @file
@@ -193,9 +197,10 @@ COMMAND_HANDLER(handle_flash_erase_check_command)
 
 	int j;
 	retval = p->driver->erase_check(p);
-	if (retval == ERROR_OK)
+	if (retval == ERROR_OK) {
 		command_print(CMD_CTX, "successfully checked erase state");
-	else {
+		flash_bank_state_cache_update(p);
+	} else {
 		command_print(CMD_CTX,
 			"unknown error when checking erase state of flash bank #%s at 0x%8.8" PRIx32,
 			CMD_ARGV[0],
@@ -399,12 +404,14 @@ COMMAND_HANDLER(handle_flash_write_image_command)
 
 	struct image image;
 	uint32_t written;
+	uint32_t skipped = 0;
 
 	int retval;
 
 	/* flash auto-erase is disabled by default*/
 	int auto_erase = 0;
 	bool auto_unlock = false;
+	bool delta = false;
 
 	while (CMD_ARGC) {
 		if (strcmp(CMD_ARGV[0], "erase") == 0) {
@@ -417,6 +424,11 @@ COMMAND_HANDLER(handle_flash_write_image_command)
 			CMD_ARGV++;
 			CMD_ARGC--;
 			command_print(CMD_CTX, "auto unlock enabled");
+		} else if (strcmp(CMD_ARGV[0], "delta") == 0) {
+			delta = true;
+			CMD_ARGV++;
+			CMD_ARGC--;
+			command_print(CMD_CTX, "unchanged sectors will be skipped");
 		} else
 			break;
 	}
@@ -446,7 +458,11 @@ COMMAND_HANDLER(handle_flash_write_image_command)
 	if (retval != ERROR_OK)
 		return retval;
 
-	retval = flash_write_unlock(target, &image, &written, auto_erase, auto_unlock);
+	if (delta)
+		retval = flash_write_delta(target, &image, &written, &skipped,
+				auto_erase, auto_unlock);
+	else
+		retval = flash_write_unlock(target, &image, &written, auto_erase, auto_unlock);
 	if (retval != ERROR_OK) {
 		image_close(&image);
 		return retval;
@@ -456,6 +472,14 @@ COMMAND_HANDLER(handle_flash_write_image_command)
 		command_print(CMD_CTX, "wrote %" PRIu32 " bytes from file %s "
 			"in %fs (%0.3f KiB/s)", written, CMD_ARGV[0],
 			duration_elapsed(&bench), duration_kbps(&bench, written));
+		if (skipped) {
+			/* estimate what the unchanged sectors would have cost
+			 * at the throughput of this write */
+			float elapsed = duration_elapsed(&bench);
+			command_print(CMD_CTX, "skipped %" PRIu32 " unchanged bytes "
+				"(about %fs saved)", skipped,
+				written ? elapsed * skipped / written : 0.0);
+		}
 	}
 
 	image_close(&image);
@@ -463,6 +487,268 @@ COMMAND_HANDLER(handle_flash_write_image_command)
 	return retval;
 }
 
+/* Checks the flash contents of @a target against the CRCs of the image
+ * sections, using a single algorithm run where the target supports it. */
+static int flash_gang_verify(struct target *target, struct image *image,
+		const uint32_t *section_crcs, bool *match)
+{
+	struct target_memory_check_block *blocks;
+	int *sections;
+	int num_blocks = 0;
+	int retval;
+
+	blocks = malloc(image->num_sections * sizeof(*blocks));
+	sections = malloc(image->num_sections * sizeof(*sections));
+	if (blocks == NULL || sections == NULL) {
+		LOG_ERROR("Out of memory");
+		free(sections);
+		free(blocks);
+		return ERROR_FAIL;
+	}
+
+	/* only sections which were written to flash */
+	for (int i = 0; i < image->num_sections; i++) {
+		struct flash_bank *bank;
+		if (get_flash_bank_by_addr(target, image->sections[i].base_address,
+				false, &bank) != ERROR_OK || bank == NULL)
+			continue;
+		blocks[num_blocks].address = image->sections[i].base_address;
+		blocks[num_blocks].size = image->sections[i].size;
+		sections[num_blocks] = i;
+		num_blocks++;
+	}
+
+	retval = target_checksum_memory_blocks(target, blocks, num_blocks);
+
+	*match = true;
+	for (int i = 0; retval == ERROR_OK && i < num_blocks; i++) {
+		if (blocks[i].result != section_crcs[sections[i]]) {
+			LOG_ERROR("%s: checksum mismatch in section at " TARGET_ADDR_FMT,
+				target_name(target), blocks[i].address);
+			*match = false;
+		}
+	}
+
+	free(sections);
+	free(blocks);
+	return retval;
+}
+
+/* Makes the TAPs of targets[1..] follow the TAP of targets[0], or
+ * releases them again. */
+static int flash_gang_join(struct target **targets, int num_targets, bool join)
+{
+	int retval = ERROR_OK;
+
+	for (int i = 1; i < num_targets; i++) {
+		int r = jtag_tap_set_gang_leader(targets[i]->tap,
+				join ? targets[0]->tap : NULL);
+		if (r != ERROR_OK)
+			retval = r;
+	}
+	return retval;
+}
+
+/* A gang member has executed the leader's debug accesses without its
+ * own state being updated; drop everything cached about it. */
+static void flash_gang_member_resync(struct target *target)
+{
+	for (struct reg_cache *cache = target->reg_cache; cache; cache = cache->next)
+		register_cache_invalidate(cache);
+
+	struct arm *arm = target_to_arm(target);
+	if (is_arm(arm) && arm->dap)
+		dap_invalidate_cache(arm->dap);
+}
+
+static int flash_gang_check_targets(struct command_context *cmd_ctx,
+		struct target **targets, int num_targets)
+{
+	if (!transport_is_jtag()) {
+		command_print(cmd_ctx, "gang programming requires the JTAG transport");
+		return ERROR_FAIL;
+	}
+
+	for (int i = 0; i < num_targets; i++) {
+		struct target *target = targets[i];
+
+		if (target->state != TARGET_HALTED) {
+			command_print(cmd_ctx, "%s: target not halted", target_name(target));
+			return ERROR_TARGET_NOT_HALTED;
+		}
+		if (strcmp(target_type_name(target), target_type_name(targets[0])) != 0
+				|| !target->tap
+				|| target->tap->ir_length != targets[0]->tap->ir_length) {
+			command_print(cmd_ctx, "%s: not identical to %s",
+				target_name(target), target_name(targets[0]));
+			return ERROR_COMMAND_ARGUMENT_INVALID;
+		}
+		for (int j = 0; j < i; j++) {
+			if (targets[j]->tap == target->tap) {
+				command_print(cmd_ctx, "%s and %s share TAP %s",
+					target_name(targets[j]), target_name(target),
+					target->tap->dotted_name);
+				return ERROR_COMMAND_ARGUMENT_INVALID;
+			}
+		}
+	}
+	return ERROR_OK;
+}
+
+COMMAND_HANDLER(handle_flash_write_image_gang_command)
+{
+	struct image image;
+	int auto_erase = 0;
+	bool auto_unlock = false;
+	int retval;
+
+	while (CMD_ARGC) {
+		if (strcmp(CMD_ARGV[0], "erase") == 0) {
+			auto_erase = 1;
+			CMD_ARGV++;
+			CMD_ARGC--;
+		} else if (strcmp(CMD_ARGV[0], "unlock") == 0) {
+			auto_unlock = true;
+			CMD_ARGV++;
+			CMD_ARGC--;
+		} else
+			break;
+	}
+
+	if (CMD_ARGC < 2 || CMD_ARGC > 4)
+		return ERROR_COMMAND_SYNTAX_ERROR;
+
+	if (CMD_ARGC >= 3) {
+		image.base_address_set = 1;
+		COMMAND_PARSE_NUMBER(llong, CMD_ARGV[2], image.base_address);
+	} else {
+		image.base_address_set = 0;
+		image.base_address = 0x0;
+	}
+
+	image.start_address_set = 0;
+
+	/* the targets to program, as a Tcl list of names */
+	Jim_Interp *interp = CMD_CTX->interp;
+	Jim_Obj *list = Jim_NewStringObj(interp, CMD_ARGV[0], -1);
+	Jim_IncrRefCount(list);
+	int num_targets = Jim_ListLength(interp, list);
+	if (num_targets <= 0) {
+		Jim_DecrRefCount(interp, list);
+		return ERROR_COMMAND_SYNTAX_ERROR;
+	}
+
+	struct target **targets = calloc(num_targets, sizeof(*targets));
+	if (targets == NULL) {
+		LOG_ERROR("Out of memory");
+		Jim_DecrRefCount(interp, list);
+		return ERROR_FAIL;
+	}
+
+	for (int i = 0; i < num_targets; i++) {
+		const char *name = Jim_GetString(Jim_ListGetIndex(interp, list, i), NULL);
+		targets[i] = get_target(name);
+		if (targets[i] == NULL) {
+			command_print(CMD_CTX, "Target '%s' not defined", name);
+			Jim_DecrRefCount(interp, list);
+			free(targets);
+			return ERROR_COMMAND_ARGUMENT_INVALID;
+		}
+	}
+	Jim_DecrRefCount(interp, list);
+
+	retval = flash_gang_check_targets(CMD_CTX, targets, num_targets);
+	if (retval != ERROR_OK) {
+		free(targets);
+		return retval;
+	}
+
+	retval = image_open(&image, CMD_ARGV[1], (CMD_ARGC == 4) ? CMD_ARGV[3] : NULL);
+	if (retval != ERROR_OK) {
+		free(targets);
+		return retval;
+	}
+
+	/* the image checksums are the same for every target */
+	uint32_t *section_crcs = calloc(image.num_sections + 1, sizeof(uint32_t));
+	if (section_crcs == NULL) {
+		LOG_ERROR("Out of memory");
+		retval = ERROR_FAIL;
+		goto done;
+	}
+
+	for (int i = 0; i < image.num_sections; i++) {
+		uint8_t *buffer = malloc(image.sections[i].size);
+		size_t buf_cnt;
+		if (buffer == NULL) {
+			LOG_ERROR("Out of memory");
+			retval = ERROR_FAIL;
+			goto done;
+		}
+		retval = image_read_section(&image, i, 0, image.sections[i].size, buffer, &buf_cnt);
+		if (retval == ERROR_OK)
+			retval = image_calculate_checksum(buffer, buf_cnt, &section_crcs[i]);
+		free(buffer);
+		if (retval != ERROR_OK)
+			goto done;
+	}
+
+	struct duration bench;
+	duration_start(&bench);
+
+	/* program all targets at once: the scans for the first target are
+	 * shifted into the TAPs of the others as well */
+	uint32_t written = 0;
+	retval = flash_gang_join(targets, num_targets, true);
+	if (retval == ERROR_OK)
+		retval = flash_write_unlock(targets[0], &image, &written,
+				auto_erase, auto_unlock);
+	if (retval != ERROR_OK)
+		LOG_WARNING("gang write failed, programming targets one by one");
+	flash_gang_join(targets, num_targets, false);
+	for (int i = 1; i < num_targets; i++)
+		flash_gang_member_resync(targets[i]);
+
+	/* verify each target on its own; one that didn't follow the gang
+	 * is programmed again by itself, without affecting the others */
+	int failed = 0;
+	for (int i = 0; i < num_targets; i++) {
+		struct target *target = targets[i];
+		bool match = false;
+
+		retval = flash_gang_verify(target, &image, section_crcs, &match);
+		if (retval == ERROR_OK && match) {
+			command_print(CMD_CTX, "%s: verified", target_name(target));
+			continue;
+		}
+
+		command_print(CMD_CTX, "%s: programming separately", target_name(target));
+		uint32_t target_written = 0;
+		retval = flash_write_unlock(target, &image, &target_written,
+				auto_erase, auto_unlock);
+		if (retval == ERROR_OK)
+			retval = flash_gang_verify(target, &image, section_crcs, &match);
+		if (retval != ERROR_OK || !match) {
+			command_print(CMD_CTX, "%s: FAILED", target_name(target));
+			failed++;
+		} else
+			command_print(CMD_CTX, "%s: verified", target_name(target));
+	}
+
+	if (duration_measure(&bench) == ERROR_OK)
+		command_print(CMD_CTX, "programmed %d of %d targets with %" PRIu32
+			" bytes each in %fs", num_targets - failed, num_targets,
+			written, duration_elapsed(&bench));
+	retval = failed ? ERROR_FAIL : ERROR_OK;
+
+done:
+	free(section_crcs);
+	image_close(&image);
+	free(targets);
+
+	return retval;
+}
+
 COMMAND_HANDLER(handle_flash_fill_command)
 {
 	target_addr_t address;
@@ -721,13 +1007,16 @@ COMMAND_HANDLER(handle_flash_write_bank_command)
 	return retval;
 }
 
+/* bank contents are streamed between flash and file in chunks of this size */
+#define FLASH_STREAM_CHUNK_SIZE		(64 * 1024)
+
 COMMAND_HANDLER(handle_flash_read_bank_command)
 {
 	uint32_t offset;
 	uint8_t *buffer;
 	struct fileio *fileio;
 	uint32_t length;
-	size_t written;
+	size_t written = 0;
 
 	if (CMD_ARGC < 2 || CMD_ARGC > 4)
 		return ERROR_COMMAND_SYNTAX_ERROR;
@@ -763,19 +1052,12 @@ COMMAND_HANDLER(handle_flash_read_bank_command)
 		return ERROR_COMMAND_ARGUMENT_INVALID;
 	}
 
-	buffer = malloc(length);
+	buffer = malloc(FLASH_STREAM_CHUNK_SIZE);
 	if (buffer == NULL) {
 		LOG_ERROR("Out of memory");
 		return ERROR_FAIL;
 	}
 
-	retval = flash_driver_read(p, buffer, offset, length);
-	if (retval != ERROR_OK) {
-		LOG_ERROR("Read error");
-		free(buffer);
-		return retval;
-	}
-
 	retval = fileio_open(&fileio, CMD_ARGV[1], FILEIO_WRITE, FILEIO_BINARY);
 	if (retval != ERROR_OK) {
 		LOG_ERROR("Could not open file");
@@ -783,13 +1065,33 @@ COMMAND_HANDLER(handle_flash_read_bank_command)
 		return retval;
 	}
 
-	retval = fileio_write(fileio, length, buffer, &written);
+	/* write each chunk out as soon as it has been read, so neither the
+	 * whole range has to be buffered nor the file waits for the last byte */
+	while (written < length) {
+		uint32_t count = MIN(length - written, FLASH_STREAM_CHUNK_SIZE);
+		size_t chunk_written;
+
+		retval = flash_driver_read(p, buffer, offset + written, count);
+		if (retval != ERROR_OK) {
+			LOG_ERROR("Read error");
+			break;
+		}
+
+		retval = fileio_write(fileio, count, buffer, &chunk_written);
+		if (retval != ERROR_OK || chunk_written != count) {
+			LOG_ERROR("Could not write file");
+			retval = ERROR_FAIL;
+			break;
+		}
+
+		written += count;
+		keep_alive();
+	}
+
 	fileio_close(fileio);
 	free(buffer);
-	if (retval != ERROR_OK) {
-		LOG_ERROR("Could not write file");
-		return ERROR_FAIL;
-	}
+	if (retval != ERROR_OK)
+		return retval;
 
 	if (duration_measure(&bench) == ERROR_OK)
 		command_print(CMD_CTX, "wrote %zd bytes to file %s from flash bank %u"
@@ -800,6 +1102,26 @@ COMMAND_HANDLER(handle_flash_read_bank_command)
 	return retval;
 }
 
+/* Checks a chunk of the bank by checksum, computed on the target where the
+ * flash is memory mapped, without reading the contents back. */
+static int flash_verify_chunk_crc(struct flash_bank *bank, uint8_t *buffer,
+		uint32_t offset, uint32_t count, bool *match)
+{
+	uint32_t flash_crc, file_crc;
+	int retval;
+
+	retval = target_checksum_memory(bank->target, bank->base + offset,
+			count, &flash_crc);
+	if (retval != ERROR_OK)
+		return retval;
+
+	retval = image_calculate_checksum(buffer, count, &file_crc);
+	if (retval != ERROR_OK)
+		return retval;
+
+	*match = (flash_crc == file_crc);
+	return ERROR_OK;
+}
 
 COMMAND_HANDLER(handle_flash_verify_bank_command)
 {
@@ -809,7 +1131,14 @@ COMMAND_HANDLER(handle_flash_verify_bank_command)
 	size_t read_cnt;
 	size_t filesize;
 	size_t length;
-	int differ;
+	size_t done;
+	bool use_crc = false;
+	int diffs = 0;
+
+	if (CMD_ARGC > 2 && strcmp(CMD_ARGV[CMD_ARGC - 1], "crc") == 0) {
+		use_crc = true;
+		CMD_ARGC--;
+	}
 
 	if (CMD_ARGC < 2 || CMD_ARGC > 3)
 		return ERROR_COMMAND_SYNTAX_ERROR;
@@ -833,6 +1162,12 @@ COMMAND_HANDLER(handle_flash_verify_bank_command)
 		return ERROR_COMMAND_ARGUMENT_INVALID;
 	}
 
+	if (use_crc && p->driver->read != default_flash_read) {
+		LOG_INFO("Flash bank %u is not memory mapped, comparing its contents "
+			"instead of checksums", p->bank_number);
+		use_crc = false;
+	}
+
 	retval = fileio_open(&fileio, CMD_ARGV[1], FILEIO_READ, FILEIO_BINARY);
 	if (retval != ERROR_OK) {
 		LOG_ERROR("Could not open file");
@@ -857,69 +1192,80 @@ COMMAND_HANDLER(handle_flash_verify_bank_command)
 		LOG_INFO("File content exceeds flash bank size. Only comparing the "
 			"first %zu bytes of the file", length);
 
-	buffer_file = malloc(length);
-	if (buffer_file == NULL) {
+	buffer_file = malloc(FLASH_STREAM_CHUNK_SIZE);
+	buffer_flash = malloc(FLASH_STREAM_CHUNK_SIZE);
+	if (buffer_file == NULL || buffer_flash == NULL) {
 		LOG_ERROR("Out of memory");
+		free(buffer_flash);
+		free(buffer_file);
 		fileio_close(fileio);
 		return ERROR_FAIL;
 	}
 
-	retval = fileio_read(fileio, length, buffer_file, &read_cnt);
-	fileio_close(fileio);
-	if (retval != ERROR_OK) {
-		LOG_ERROR("File read failure");
-		free(buffer_file);
-		return retval;
-	}
+	for (done = 0; done < length; done += read_cnt) {
+		uint32_t count = MIN(length - done, FLASH_STREAM_CHUNK_SIZE);
+		uint32_t chunk_offset = offset + done;
 
-	if (read_cnt != length) {
-		LOG_ERROR("Short read");
-		free(buffer_file);
-		return ERROR_FAIL;
-	}
+		retval = fileio_read(fileio, count, buffer_file, &read_cnt);
+		if (retval != ERROR_OK) {
+			LOG_ERROR("File read failure");
+			break;
+		}
 
-	buffer_flash = malloc(length);
-	if (buffer_flash == NULL) {
-		LOG_ERROR("Out of memory");
-		free(buffer_file);
-		return ERROR_FAIL;
-	}
+		if (read_cnt != count) {
+			LOG_ERROR("Short read");
+			retval = ERROR_FAIL;
+			break;
+		}
 
-	retval = flash_driver_read(p, buffer_flash, offset, length);
-	if (retval != ERROR_OK) {
-		LOG_ERROR("Flash read error");
-		free(buffer_flash);
-		free(buffer_file);
-		return retval;
-	}
+		if (use_crc) {
+			bool match;
+			retval = flash_verify_chunk_crc(p, buffer_file, chunk_offset, count, &match);
+			if (retval != ERROR_OK) {
+				LOG_ERROR("Flash checksum error");
+				break;
+			}
+			if (match)
+				continue;
+		}
 
-	if (duration_measure(&bench) == ERROR_OK)
-		command_print(CMD_CTX, "read %zd bytes from file %s and flash bank %u"
-			" at offset 0x%8.8" PRIx32 " in %fs (%0.3f KiB/s)",
-			length, CMD_ARGV[1], p->bank_number, offset,
-			duration_elapsed(&bench), duration_kbps(&bench, length));
+		/* read back to compare, or to locate a checksum mismatch */
+		retval = flash_driver_read(p, buffer_flash, chunk_offset, count);
+		if (retval != ERROR_OK) {
+			LOG_ERROR("Flash read error");
+			break;
+		}
 
-	differ = memcmp(buffer_file, buffer_flash, length);
-	command_print(CMD_CTX, "contents %s", differ ? "differ" : "match");
-	if (differ) {
-		uint32_t t;
-		int diffs = 0;
-		for (t = 0; t < length; t++) {
+		if (memcmp(buffer_file, buffer_flash, count) == 0)
+			continue;
+
+		for (uint32_t t = 0; t < count && diffs < 128; t++) {
 			if (buffer_flash[t] == buffer_file[t])
 				continue;
-			command_print(CMD_CTX, "diff %d address 0x%08x. Was 0x%02x instead of 0x%02x",
-					diffs, t + offset, buffer_flash[t], buffer_file[t]);
-			if (diffs++ >= 127) {
+			command_print(CMD_CTX, "diff %d address 0x%08" PRIx32 ". Was 0x%02x instead of 0x%02x",
+					diffs, t + chunk_offset, buffer_flash[t], buffer_file[t]);
+			if (diffs++ >= 127)
 				command_print(CMD_CTX, "More than 128 errors, the rest are not printed.");
-				break;
-			}
-			keep_alive();
 		}
+		keep_alive();
 	}
+
+	fileio_close(fileio);
 	free(buffer_flash);
 	free(buffer_file);
 
-	return differ ? ERROR_FAIL : ERROR_OK;
+	if (retval != ERROR_OK)
+		return retval;
+
+	if (duration_measure(&bench) == ERROR_OK)
+		command_print(CMD_CTX, "read %zd bytes from file %s and flash bank %u"
+			" at offset 0x%8.8" PRIx32 " in %fs (%0.3f KiB/s)",
+			length, CMD_ARGV[1], p->bank_number, offset,
+			duration_elapsed(&bench), duration_kbps(&bench, length));
+
+	command_print(CMD_CTX, "contents %s", diffs ? "differ" : "match");
+
+	return diffs ? ERROR_FAIL : ERROR_OK;
 }
 
 void flash_set_dirty(void)
@@ -1032,11 +1378,21 @@ static const struct command_registration flash_exec_command_handlers[] = {
 		.name = "write_image",
 		.handler = handle_flash_write_image_command,
 		.mode = COMMAND_EXEC,
-		.usage = "[erase] [unlock] filename [offset [file_type]]",
+		.usage = "[erase] [unlock] [delta] filename [offset [file_type]]",
 		.help = "Write an image to flash.  Optionally first unprotect "
-			"and/or erase the region to be used.  Allow optional "
+			"and/or erase the region to be used, or skip sectors "
+			"already holding the image.  Allow optional "
 			"offset from beginning of bank (defaults to zero)",
 	},
+	{
+		.name = "write_image_gang",
+		.handler = handle_flash_write_image_gang_command,
+		.mode = COMMAND_EXEC,
+		.usage = "[erase] [unlock] target_list filename [offset [file_type]]",
+		.help = "Write an image to the flash of a list of identical "
+			"targets on one JTAG chain at once, then verify each "
+			"target and reprogram those which don't match.",
+	},
 	{
 		.name = "read_bank",
 		.handler = handle_flash_read_bank_command,
@@ -1049,7 +1405,7 @@ static const struct command_registration flash_exec_command_handlers[] = {
 		.name = "verify_bank",
 		.handler = handle_flash_verify_bank_command,
 		.mode = COMMAND_EXEC,
-		.usage = "bank_id filename [offset]",
+		.usage = "bank_id filename [offset] ['crc']",
 		.help = "Compare the contents of a file with the contents of the "
 			"flash bank. Allow optional offset from beginning of the bank "
 			"(defaults to zero).",
@@ -1217,6 +1573,23 @@ COMMAND_HANDLER(handle_flash_init_command)
 	return flash_init_drivers(CMD_CTX);
 }
 
+COMMAND_HANDLER(handle_flash_state_cache_command)
+{
+	if (CMD_ARGC > 1)
+		return ERROR_COMMAND_SYNTAX_ERROR;
+
+	if (CMD_ARGC == 1) {
+		if (strcmp(CMD_ARGV[0], "off") == 0)
+			flash_state_cache_set_dir(NULL);
+		else
+			flash_state_cache_set_dir(CMD_ARGV[0]);
+	}
+
+	const char *dir = flash_state_cache_get_dir();
+	command_print(CMD_CTX, "flash state cache: %s", dir ? dir : "off");
+	return ERROR_OK;
+}
+
 static const struct command_registration flash_config_command_handlers[] = {
 	{
 		.name = "bank",
@@ -1246,6 +1619,14 @@ static const struct command_registration flash_config_command_handlers[] = {
 		.jim_handler = jim_flash_list,
 		.help = "Returns a list of details about the flash banks.",
 	},
+	{
+		.name = "state_cache",
+		.mode = COMMAND_ANY,
+		.handler = handle_flash_state_cache_command,
+		.usage = "[directory|'off']",
+		.help = "Set or display the directory caching bad block tables "
+			"and erase states of NOR banks and NAND devices.",
+	},
 	COMMAND_REGISTRATION_DONE
 };
 static const struct command_registration flash_command_handlers[] = {
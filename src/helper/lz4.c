@@ -0,0 +1,116 @@
+/***************************************************************************
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program.  If not, see <http://www.gnu.org/licenses/>. *
+ ***************************************************************************/
+
+/* A simple greedy LZ4 block compressor. Speed matters more than ratio
+ * here: the data is compressed right before it goes over the debug link. */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <string.h>
+
+#include "lz4.h"
+
+#define LZ4_MIN_MATCH		4
+#define LZ4_MAX_OFFSET		0xffff
+/* the format requires the last bytes of a block to be literals */
+#define LZ4_LAST_LITERALS	5
+#define LZ4_MATCH_LIMIT		12
+#define LZ4_HASH_BITS		12
+
+static uint32_t lz4_hash(const uint8_t *p)
+{
+	uint32_t v = p[0] | (p[1] << 8) | (p[2] << 16) | ((uint32_t)p[3] << 24);
+	return (v * 2654435761u) >> (32 - LZ4_HASH_BITS);
+}
+
+/* worst case size of a sequence, to check for room before emitting it */
+static size_t lz4_sequence_size(size_t literals, size_t match_length)
+{
+	return 1 + literals + literals / 255 + 1 + 2 + match_length / 255 + 1;
+}
+
+static uint8_t *lz4_put_length(uint8_t *op, size_t length)
+{
+	while (length >= 255) {
+		*op++ = 255;
+		length -= 255;
+	}
+	*op++ = length;
+	return op;
+}
+
+static uint8_t *lz4_put_literals(uint8_t *op, const uint8_t *literals,
+		size_t count, unsigned int match_length)
+{
+	*op++ = ((count < 15 ? count : 15) << 4) | (match_length < 15 ? match_length : 15);
+	if (count >= 15)
+		op = lz4_put_length(op, count - 15);
+	memcpy(op, literals, count);
+	return op + count;
+}
+
+size_t lz4_compress_block(const uint8_t *in, size_t in_size,
+		uint8_t *out, size_t out_size)
+{
+	uint32_t table[1 << LZ4_HASH_BITS];
+	uint8_t *op = out;
+	size_t ip = 0, anchor = 0;
+
+	memset(table, 0, sizeof(table));
+
+	if (in_size > LZ4_MATCH_LIMIT) {
+		size_t match_limit = in_size - LZ4_MATCH_LIMIT;
+		size_t length_limit = in_size - LZ4_LAST_LITERALS;
+
+		while (ip < match_limit) {
+			uint32_t h = lz4_hash(in + ip);
+			size_t candidate = table[h];
+			table[h] = ip;
+
+			if (candidate >= ip || ip - candidate > LZ4_MAX_OFFSET
+					|| memcmp(in + candidate, in + ip, LZ4_MIN_MATCH) != 0) {
+				ip++;
+				continue;
+			}
+
+			size_t length = LZ4_MIN_MATCH;
+			while (ip + length < length_limit && in[candidate + length] == in[ip + length])
+				length++;
+
+			size_t literals = ip - anchor;
+			if ((size_t)(op - out) + lz4_sequence_size(literals, length) > out_size)
+				return 0;
+
+			size_t match_length = length - LZ4_MIN_MATCH;
+			op = lz4_put_literals(op, in + anchor, literals, match_length);
+			*op++ = (ip - candidate) & 0xff;
+			*op++ = (ip - candidate) >> 8;
+			if (match_length >= 15)
+				op = lz4_put_length(op, match_length - 15);
+
+			ip += length;
+			anchor = ip;
+		}
+	}
+
+	size_t literals = in_size - anchor;
+	if ((size_t)(op - out) + 1 + literals + literals / 255 + 1 > out_size)
+		return 0;
+	op = lz4_put_literals(op, in + anchor, literals, 0);
+
+	return op - out;
+}
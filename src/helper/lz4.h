@@ -0,0 +1,31 @@
+/***************************************************************************
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program.  If not, see <http://www.gnu.org/licenses/>. *
+ ***************************************************************************/
+
+#ifndef OPENOCD_HELPER_LZ4_H
+#define OPENOCD_HELPER_LZ4_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * Compresses @a in_size bytes from @a in into a raw LZ4 block, as unpacked
+ * by the target side decompressors in contrib/loaders/decompress.
+ * @returns the size of the compressed block, or zero if it would not fit
+ * into the @a out_size bytes at @a out.
+ */
+size_t lz4_compress_block(const uint8_t *in, size_t in_size,
+		uint8_t *out, size_t out_size);
+
+#endif /* OPENOCD_HELPER_LZ4_H */
@@ -272,6 +272,39 @@ struct jtag_tap *jtag_tap_next_enabled(struct jtag_tap *p)
 	return NULL;
 }
 
+int jtag_tap_set_gang_leader(struct jtag_tap *tap, struct jtag_tap *leader)
+{
+	if (leader) {
+		if (leader == tap || leader->gang_leader
+				|| !tap->enabled || !leader->enabled
+				|| tap->ir_length != leader->ir_length) {
+			LOG_ERROR("TAP %s can't follow TAP %s",
+				tap->dotted_name, leader->dotted_name);
+			return ERROR_JTAG_DEVICE_ERROR;
+		}
+		for (struct jtag_tap *t = jtag_all_taps(); t; t = t->next_tap) {
+			if (t->gang_leader == tap) {
+				LOG_ERROR("TAP %s already leads a gang", tap->dotted_name);
+				return ERROR_JTAG_DEVICE_ERROR;
+			}
+		}
+	}
+
+	struct jtag_tap *sync = leader ? leader : tap->gang_leader;
+	tap->gang_leader = leader;
+	if (!sync)
+		return ERROR_OK;
+
+	/* rescan the leader's current instruction, which loads it into the
+	 * new member, or puts a leaving member into BYPASS */
+	struct scan_field field = {
+		.num_bits = sync->ir_length,
+		.out_value = sync->cur_instr,
+	};
+	jtag_add_ir_scan(sync, &field, TAP_IDLE);
+	return jtag_execute_queue();
+}
+
 const char *jtag_tap_name(const struct jtag_tap *tap)
 {
 	return (tap == NULL) ? "(unknown)" : tap->dotted_name;
@@ -51,6 +51,8 @@ static volatile uint32_t *pio_base;
 
 static bb_value_t bcm2835gpio_read(void);
 static int bcm2835gpio_write(int tck, int tms, int tdi);
+static int bcm2835gpio_scan_bits(const uint8_t *tms, const uint8_t *tdi,
+		uint8_t *tdo, unsigned num_bits);
 static int bcm2835gpio_reset(int trst, int srst);
 
 static int bcm2835_swdio_read(void);
@@ -62,6 +64,7 @@ static int bcm2835gpio_quit(void);
 static struct bitbang_interface bcm2835gpio_bitbang = {
 	.read = bcm2835gpio_read,
 	.write = bcm2835gpio_write,
+	.scan_bits = bcm2835gpio_scan_bits,
 	.reset = bcm2835gpio_reset,
 	.swdio_read = bcm2835_swdio_read,
 	.swdio_drive = bcm2835_swdio_drive,
@@ -91,6 +94,12 @@ static int speed_coeff = 113714;
 static int speed_offset = 28;
 static unsigned int jtag_delay;
 
+static inline void bcm2835gpio_delay(void)
+{
+	for (unsigned int i = 0; i < jtag_delay; i++)
+		asm volatile ("");
+}
+
 static bb_value_t bcm2835gpio_read(void)
 {
 	return (GPIO_LEV & 1<<tdo_gpio) ? BB_HIGH : BB_LOW;
@@ -104,8 +113,54 @@ static int bcm2835gpio_write(int tck, int tms, int tdi)
 	GPIO_SET = set;
 	GPIO_CLR = clear;
 
-	for (unsigned int i = 0; i < jtag_delay; i++)
-		asm volatile ("");
+	bcm2835gpio_delay();
+
+	return ERROR_OK;
+}
+
+/* Burst mode: clock a whole TMS/TDI sequence with set/clear masks computed
+ * from the previous pin levels, so that each edge only touches the pins
+ * that actually change, and sample TDO with a single GPLEV read per bit. */
+static int bcm2835gpio_scan_bits(const uint8_t *tms, const uint8_t *tdi,
+		uint8_t *tdo, unsigned num_bits)
+{
+	const uint32_t tck_mask = 1 << tck_gpio;
+	const uint32_t tms_mask = 1 << tms_gpio;
+	const uint32_t tdi_mask = 1 << tdi_gpio;
+	const uint32_t tdo_mask = 1 << tdo_gpio;
+	uint32_t level = GPIO_LEV & (tms_mask | tdi_mask);
+
+	for (unsigned i = 0; i < num_bits; i++) {
+		uint8_t bit = 1 << (i % 8);
+		uint32_t next = 0;
+
+		if (tms && (tms[i / 8] & bit))
+			next |= tms_mask;
+		if (tdi && (tdi[i / 8] & bit))
+			next |= tdi_mask;
+
+		/* falling edge of TCK, TMS and TDI change with it */
+		GPIO_CLR = tck_mask | (level & ~next);
+		if (next & ~level)
+			GPIO_SET = next & ~level;
+		level = next;
+		bcm2835gpio_delay();
+
+		if (tdo) {
+			if (GPIO_LEV & tdo_mask)
+				tdo[i / 8] |= bit;
+			else
+				tdo[i / 8] &= ~bit;
+		}
+
+		/* rising edge of TCK, nothing else changes */
+		GPIO_SET = tck_mask;
+		bcm2835gpio_delay();
+	}
+
+	/* leave TCK and TDI low, TMS keeps its last value */
+	GPIO_CLR = tck_mask | (level & tdi_mask);
+	bcm2835gpio_delay();
 
 	return ERROR_OK;
 }
@@ -118,8 +173,7 @@ static int bcm2835gpio_swd_write(int tck, int tms, int tdi)
 	GPIO_SET = set;
 	GPIO_CLR = clear;
 
-	for (unsigned int i = 0; i < jtag_delay; i++)
-		asm volatile ("");
+	bcm2835gpio_delay();
 
 	return ERROR_OK;
 }
@@ -445,14 +499,22 @@ static int bcm2835gpio_init(void)
 		return ERROR_JTAG_INIT_FAILED;
 	}
 
-	dev_mem_fd = open("/dev/mem", O_RDWR | O_SYNC);
+	/* /dev/gpiomem maps just the GPIO block at offset 0 and does not
+	 * require root, but gives no access to the pad control registers */
+	bool use_gpiomem = true;
+	dev_mem_fd = open("/dev/gpiomem", O_RDWR | O_SYNC);
+	if (dev_mem_fd < 0) {
+		LOG_DEBUG("/dev/gpiomem not available, falling back to /dev/mem");
+		use_gpiomem = false;
+		dev_mem_fd = open("/dev/mem", O_RDWR | O_SYNC);
+	}
 	if (dev_mem_fd < 0) {
 		perror("open");
 		return ERROR_JTAG_INIT_FAILED;
 	}
 
 	pio_base = mmap(NULL, sysconf(_SC_PAGE_SIZE), PROT_READ | PROT_WRITE,
-				MAP_SHARED, dev_mem_fd, BCM2835_GPIO_BASE);
+				MAP_SHARED, dev_mem_fd, use_gpiomem ? 0 : BCM2835_GPIO_BASE);
 
 	if (pio_base == MAP_FAILED) {
 		perror("mmap");
@@ -460,18 +522,21 @@ static int bcm2835gpio_init(void)
 		return ERROR_JTAG_INIT_FAILED;
 	}
 
-	static volatile uint32_t *pads_base;
-	pads_base = mmap(NULL, sysconf(_SC_PAGE_SIZE), PROT_READ | PROT_WRITE,
-				MAP_SHARED, dev_mem_fd, BCM2835_PADS_GPIO_0_27);
+	if (!use_gpiomem) {
+		static volatile uint32_t *pads_base;
+		pads_base = mmap(NULL, sysconf(_SC_PAGE_SIZE), PROT_READ | PROT_WRITE,
+					MAP_SHARED, dev_mem_fd, BCM2835_PADS_GPIO_0_27);
 
-	if (pads_base == MAP_FAILED) {
-		perror("mmap");
-		close(dev_mem_fd);
-		return ERROR_JTAG_INIT_FAILED;
-	}
+		if (pads_base == MAP_FAILED) {
+			perror("mmap");
+			close(dev_mem_fd);
+			return ERROR_JTAG_INIT_FAILED;
+		}
 
-	/* set 4mA drive strength, slew rate limited, hysteresis on */
-	pads_base[BCM2835_PADS_GPIO_0_27_OFFSET] = 0x5a000008 + 1;
+		/* set 4mA drive strength, slew rate limited, hysteresis on */
+		pads_base[BCM2835_PADS_GPIO_0_27_OFFSET] = 0x5a000008 + 1;
+	} else
+		LOG_INFO("using /dev/gpiomem, pad drive strength left unchanged");
 
 	tdo_gpio_mode = MODE_GPIO(tdo_gpio);
 	tdi_gpio_mode = MODE_GPIO(tdi_gpio);
@@ -510,6 +575,7 @@ static int bcm2835gpio_init(void)
 
 	if (swd_mode) {
 		bcm2835gpio_bitbang.write = bcm2835gpio_swd_write;
+		bcm2835gpio_bitbang.scan_bits = NULL;
 		bitbang_switch_to_swd();
 	}
 
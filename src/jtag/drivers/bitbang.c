@@ -74,20 +74,86 @@ static void bitbang_end_state(tap_state_t state)
 	tap_set_end_state(state);
 }
 
-static int bitbang_state_move(int skip)
+/**
+ * Clock a sequence of TMS/TDI bits, optionally capturing TDO.
+ *
+ * Bit vectors are packed LSB first; a NULL @a tms or @a tdi clocks zeros and
+ * a NULL @a tdo skips sampling. When the interface implements scan_bits()
+ * the whole sequence is handed over in one call, otherwise it is clocked
+ * one bit at a time through write() and read() or the sample functions.
+ * TCK is left low afterwards.
+ */
+static int bitbang_clock_bits(const uint8_t *tms, const uint8_t *tdi,
+		uint8_t *tdo, unsigned num_bits)
 {
-	int i = 0, tms = 0;
-	uint8_t tms_scan = tap_get_tms_path(tap_get_state(), tap_get_end_state());
-	int tms_count = tap_get_tms_path_len(tap_get_state(), tap_get_end_state());
+	if (num_bits == 0)
+		return ERROR_OK;
+
+	if (bitbang_interface->scan_bits)
+		return bitbang_interface->scan_bits(tms, tdi, tdo, num_bits);
 
-	for (i = skip; i < tms_count; i++) {
-		tms = (tms_scan >> i) & 1;
-		if (bitbang_interface->write(0, tms, 0) != ERROR_OK)
+	size_t buffered = 0;
+	int tms_bit = 0;
+	for (unsigned i = 0; i < num_bits; i++) {
+		int bytec = i / 8;
+		int bcval = 1 << (i % 8);
+		int tdi_bit = tdi && (tdi[bytec] & bcval) ? 1 : 0;
+		tms_bit = tms && (tms[bytec] & bcval) ? 1 : 0;
+
+		if (bitbang_interface->write(0, tms_bit, tdi_bit) != ERROR_OK)
 			return ERROR_FAIL;
-		if (bitbang_interface->write(1, tms, 0) != ERROR_OK)
+
+		if (tdo) {
+			if (bitbang_interface->buf_size) {
+				if (bitbang_interface->sample() != ERROR_OK)
+					return ERROR_FAIL;
+				buffered++;
+			} else {
+				switch (bitbang_interface->read()) {
+					case BB_LOW:
+						tdo[bytec] &= ~bcval;
+						break;
+					case BB_HIGH:
+						tdo[bytec] |= bcval;
+						break;
+					default:
+						return ERROR_FAIL;
+				}
+			}
+		}
+
+		if (bitbang_interface->write(1, tms_bit, tdi_bit) != ERROR_OK)
 			return ERROR_FAIL;
+
+		if (tdo && bitbang_interface->buf_size &&
+				(buffered == bitbang_interface->buf_size ||
+				 i == num_bits - 1)) {
+			for (unsigned j = i + 1 - buffered; j <= i; j++) {
+				switch (bitbang_interface->read_sample()) {
+					case BB_LOW:
+						tdo[j/8] &= ~(1 << (j % 8));
+						break;
+					case BB_HIGH:
+						tdo[j/8] |= 1 << (j % 8);
+						break;
+					default:
+						return ERROR_FAIL;
+				}
+			}
+			buffered = 0;
+		}
 	}
-	if (bitbang_interface->write(CLOCK_IDLE(), tms, 0) != ERROR_OK)
+
+	return bitbang_interface->write(CLOCK_IDLE(), tms_bit, 0);
+}
+
+static int bitbang_state_move(int skip)
+{
+	uint8_t tms_scan = tap_get_tms_path(tap_get_state(), tap_get_end_state());
+	int tms_count = tap_get_tms_path_len(tap_get_state(), tap_get_end_state());
+
+	tms_scan >>= skip;
+	if (bitbang_clock_bits(&tms_scan, NULL, NULL, tms_count - skip) != ERROR_OK)
 		return ERROR_FAIL;
 
 	tap_set_state(tap_get_end_state());
@@ -105,50 +171,38 @@ static int bitbang_execute_tms(struct jtag_command *cmd)
 
 	DEBUG_JTAG_IO("TMS: %d bits", num_bits);
 
-	int tms = 0;
-	for (unsigned i = 0; i < num_bits; i++) {
-		tms = ((bits[i/8] >> (i % 8)) & 1);
-		if (bitbang_interface->write(0, tms, 0) != ERROR_OK)
-			return ERROR_FAIL;
-		if (bitbang_interface->write(1, tms, 0) != ERROR_OK)
-			return ERROR_FAIL;
-	}
-	if (bitbang_interface->write(CLOCK_IDLE(), tms, 0) != ERROR_OK)
-		return ERROR_FAIL;
-
-	return ERROR_OK;
+	return bitbang_clock_bits(bits, NULL, NULL, num_bits);
 }
 
 static int bitbang_path_move(struct pathmove_command *cmd)
 {
 	int num_states = cmd->num_states;
 	int state_count;
-	int tms = 0;
-
-	state_count = 0;
-	while (num_states) {
-		if (tap_state_transition(tap_get_state(), false) == cmd->path[state_count])
-			tms = 0;
-		else if (tap_state_transition(tap_get_state(), true) == cmd->path[state_count])
-			tms = 1;
-		else {
-			LOG_ERROR("BUG: %s -> %s isn't a valid TAP transition",
-				tap_state_name(tap_get_state()),
-				tap_state_name(cmd->path[state_count]));
-			exit(-1);
-		}
+	int retval;
 
-		if (bitbang_interface->write(0, tms, 0) != ERROR_OK)
-			return ERROR_FAIL;
-		if (bitbang_interface->write(1, tms, 0) != ERROR_OK)
-			return ERROR_FAIL;
+	uint8_t *tms_path = calloc(DIV_ROUND_UP(num_states, 8), 1);
+	if (!tms_path) {
+		LOG_ERROR("Out of memory");
+		return ERROR_FAIL;
+	}
+
+	for (state_count = 0; state_count < num_states; state_count++) {
+		if (tap_state_transition(tap_get_state(), false) != cmd->path[state_count]) {
+			if (tap_state_transition(tap_get_state(), true) != cmd->path[state_count]) {
+				LOG_ERROR("BUG: %s -> %s isn't a valid TAP transition",
+					tap_state_name(tap_get_state()),
+					tap_state_name(cmd->path[state_count]));
+				exit(-1);
+			}
+			tms_path[state_count / 8] |= 1 << (state_count % 8);
+		}
 
 		tap_set_state(cmd->path[state_count]);
-		state_count++;
-		num_states--;
 	}
 
-	if (bitbang_interface->write(CLOCK_IDLE(), tms, 0) != ERROR_OK)
+	retval = bitbang_clock_bits(tms_path, NULL, NULL, num_states);
+	free(tms_path);
+	if (retval != ERROR_OK)
 		return ERROR_FAIL;
 
 	tap_set_end_state(tap_get_state());
@@ -157,8 +211,6 @@ static int bitbang_path_move(struct pathmove_command *cmd)
 
 static int bitbang_runtest(int num_cycles)
 {
-	int i;
-
 	tap_state_t saved_end_state = tap_get_end_state();
 
 	/* only do a state_move when we're not already in IDLE */
@@ -169,13 +221,7 @@ static int bitbang_runtest(int num_cycles)
 	}
 
 	/* execute num_cycles */
-	for (i = 0; i < num_cycles; i++) {
-		if (bitbang_interface->write(0, 0, 0) != ERROR_OK)
-			return ERROR_FAIL;
-		if (bitbang_interface->write(1, 0, 0) != ERROR_OK)
-			return ERROR_FAIL;
-	}
-	if (bitbang_interface->write(CLOCK_IDLE(), 0, 0) != ERROR_OK)
+	if (bitbang_clock_bits(NULL, NULL, NULL, num_cycles) != ERROR_OK)
 		return ERROR_FAIL;
 
 	/* finish in end_state */
@@ -189,15 +235,26 @@ static int bitbang_runtest(int num_cycles)
 
 static int bitbang_stableclocks(int num_cycles)
 {
-	int tms = (tap_get_state() == TAP_RESET ? 1 : 0);
-	int i;
+	static const uint8_t tms_ones[64] = {
+		0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+		0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+		0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+		0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+		0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+		0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+		0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+		0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+	};
 
 	/* send num_cycles clocks onto the cable */
-	for (i = 0; i < num_cycles; i++) {
-		if (bitbang_interface->write(1, tms, 0) != ERROR_OK)
-			return ERROR_FAIL;
-		if (bitbang_interface->write(0, tms, 0) != ERROR_OK)
+	if (tap_get_state() != TAP_RESET)
+		return bitbang_clock_bits(NULL, NULL, NULL, num_cycles);
+
+	while (num_cycles > 0) {
+		int chunk = MIN(num_cycles, (int)sizeof(tms_ones) * 8);
+		if (bitbang_clock_bits(tms_ones, NULL, NULL, chunk) != ERROR_OK)
 			return ERROR_FAIL;
+		num_cycles -= chunk;
 	}
 
 	return ERROR_OK;
@@ -207,7 +264,7 @@ static int bitbang_scan(bool ir_scan, enum scan_type type, uint8_t *buffer,
 		unsigned scan_size)
 {
 	tap_state_t saved_end_state = tap_get_end_state();
-	unsigned bit_cnt;
+	int retval;
 
 	if (!((!ir_scan &&
 			(tap_get_state() == TAP_DRSHIFT)) ||
@@ -222,64 +279,27 @@ static int bitbang_scan(bool ir_scan, enum scan_type type, uint8_t *buffer,
 		bitbang_end_state(saved_end_state);
 	}
 
-	size_t buffered = 0;
-	for (bit_cnt = 0; bit_cnt < scan_size; bit_cnt++) {
-		int tms = (bit_cnt == scan_size-1) ? 1 : 0;
-		int tdi;
-		int bytec = bit_cnt/8;
-		int bcval = 1 << (bit_cnt % 8);
-
-		/* if we're just reading the scan, but don't care about the output
-		 * default to outputting 'low', this also makes valgrind traces more readable,
-		 * as it removes the dependency on an uninitialised value
-		 */
-		tdi = 0;
-		if ((type != SCAN_IN) && (buffer[bytec] & bcval))
-			tdi = 1;
-
-		if (bitbang_interface->write(0, tms, tdi) != ERROR_OK)
-			return ERROR_FAIL;
-
-		if (type != SCAN_OUT) {
-			if (bitbang_interface->buf_size) {
-				if (bitbang_interface->sample() != ERROR_OK)
-					return ERROR_FAIL;
-				buffered++;
-			} else {
-				switch (bitbang_interface->read()) {
-					case BB_LOW:
-						buffer[bytec] &= ~bcval;
-						break;
-					case BB_HIGH:
-						buffer[bytec] |= bcval;
-						break;
-					default:
-						return ERROR_FAIL;
-				}
-			}
-		}
-
-		if (bitbang_interface->write(1, tms, tdi) != ERROR_OK)
-			return ERROR_FAIL;
-
-		if (type != SCAN_OUT && bitbang_interface->buf_size &&
-				(buffered == bitbang_interface->buf_size ||
-				 bit_cnt == scan_size - 1)) {
-			for (unsigned i = bit_cnt + 1 - buffered; i <= bit_cnt; i++) {
-				switch (bitbang_interface->read_sample()) {
-					case BB_LOW:
-						buffer[i/8] &= ~(1 << (i % 8));
-						break;
-					case BB_HIGH:
-						buffer[i/8] |= 1 << (i % 8);
-						break;
-					default:
-						return ERROR_FAIL;
-				}
-			}
-			buffered = 0;
-		}
+	/* TMS stays low while shifting and goes high on the last bit to
+	 * leave the shift state */
+	uint8_t *tms = calloc(DIV_ROUND_UP(scan_size, 8), 1);
+	if (!tms) {
+		LOG_ERROR("Out of memory");
+		return ERROR_FAIL;
 	}
+	if (scan_size)
+		tms[(scan_size - 1) / 8] |= 1 << ((scan_size - 1) % 8);
+
+	/* if we're just reading the scan, but don't care about the output
+	 * default to outputting 'low', this also makes valgrind traces more readable,
+	 * as it removes the dependency on an uninitialised value
+	 */
+	retval = bitbang_clock_bits(tms,
+			type != SCAN_IN ? buffer : NULL,
+			type != SCAN_OUT ? buffer : NULL,
+			scan_size);
+	free(tms);
+	if (retval != ERROR_OK)
+		return ERROR_FAIL;
 
 	if (tap_get_state() != tap_get_end_state()) {
 		/* we *KNOW* the above loop transitioned out of
@@ -51,6 +51,21 @@ struct bitbang_interface {
 
 	/** Set TCK, TMS, and TDI to the given values. */
 	int (*write)(int tck, int tms, int tdi);
+
+	/** Optional bulk clocking of a whole bit sequence.
+	 *
+	 * For each of the @a num_bits bits, drive TCK low with the TMS and TDI
+	 * values taken from @a tms and @a tdi, sample TDO into @a tdo, then raise
+	 * TCK. When all bits have been clocked, TCK is left low with TMS holding
+	 * its last value. All vectors are packed LSB first. A NULL @a tms or
+	 * @a tdi means all zero bits; a NULL @a tdo means TDO is not sampled.
+	 * @a tdo may alias @a tdi.
+	 *
+	 * When implemented it takes precedence over write(), read() and the
+	 * sample functions for all JTAG operations. */
+	int (*scan_bits)(const uint8_t *tms, const uint8_t *tdi, uint8_t *tdo,
+			unsigned num_bits);
+
 	int (*reset)(int trst, int srst);
 	int (*blink)(int on);
 	int (*swdio_read)(void);
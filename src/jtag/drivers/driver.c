@@ -97,11 +97,16 @@ int interface_jtag_add_ir_scan(struct jtag_tap *active,
 	for (struct jtag_tap *tap = jtag_tap_next_enabled(NULL); tap != NULL; tap = jtag_tap_next_enabled(tap)) {
 		/* search the input field list for fields for the current TAP */
 
-		if (tap == active) {
+		if (tap == active || (active && tap->gang_leader == active)) {
 			/* if TAP is listed in input fields, copy the value */
 			tap->bypass = 0;
 
 			cmd_queue_scan_field_clone(field, in_fields);
+
+			/* gang members follow their leader, but only the
+			 * leader's captured value is collected */
+			if (tap != active)
+				field->in_value = NULL;
 		} else {
 			/* if a TAP isn't listed in input fields, set it to BYPASS */
 
@@ -130,18 +135,24 @@ int interface_jtag_add_ir_scan(struct jtag_tap *active,
 int interface_jtag_add_dr_scan(struct jtag_tap *active, int in_num_fields,
 		const struct scan_field *in_fields, tap_state_t state)
 {
-	/* count devices in bypass */
+	/* count devices in bypass and devices getting the input fields,
+	 * the latter is more than one when a gang follows the active TAP */
 
 	size_t bypass_devices = 0;
+	size_t active_taps = 0;
 
 	for (struct jtag_tap *tap = jtag_tap_next_enabled(NULL); tap != NULL; tap = jtag_tap_next_enabled(tap)) {
 		if (tap->bypass)
 			bypass_devices++;
+		else
+			active_taps++;
 	}
 
+	size_t num_fields = in_num_fields * active_taps + bypass_devices;
+
 	struct jtag_command *cmd = cmd_queue_alloc(sizeof(struct jtag_command));
 	struct scan_command *scan = cmd_queue_alloc(sizeof(struct scan_command));
-	struct scan_field *out_fields = cmd_queue_alloc((in_num_fields + bypass_devices) * sizeof(struct scan_field));
+	struct scan_field *out_fields = cmd_queue_alloc(num_fields * sizeof(struct scan_field));
 
 	jtag_queue_command(cmd);
 
@@ -149,7 +160,7 @@ int interface_jtag_add_dr_scan(struct jtag_tap *active, int in_num_fields,
 	cmd->cmd.scan = scan;
 
 	scan->ir_scan = false;
-	scan->num_fields = in_num_fields + bypass_devices;
+	scan->num_fields = num_fields;
 	scan->fields = out_fields;
 	scan->end_state = state;
 
@@ -161,7 +172,7 @@ int interface_jtag_add_dr_scan(struct jtag_tap *active, int in_num_fields,
 		/* if TAP is not bypassed insert matching input fields */
 
 		if (!tap->bypass) {
-			assert(active == tap);
+			assert(active == tap || tap->gang_leader == active);
 #ifndef NDEBUG
 			/* remember initial position for assert() */
 			struct scan_field *start_field = field;
@@ -169,6 +180,8 @@ int interface_jtag_add_dr_scan(struct jtag_tap *active, int in_num_fields,
 
 			for (int j = 0; j < in_num_fields; j++) {
 				cmd_queue_scan_field_clone(field, in_fields + j);
+				if (tap != active)
+					field->in_value = NULL;
 
 				field++;
 			}
@@ -133,14 +133,67 @@ static bb_value_t imx_gpio_read(void)
 	return gpio_level(tdo_gpio) ? BB_HIGH : BB_LOW;
 }
 
+static inline void imx_gpio_delay(void)
+{
+	for (unsigned int i = 0; i < jtag_delay; i++)
+		asm volatile ("");
+}
+
 static int imx_gpio_write(int tck, int tms, int tdi)
 {
 	tms ? gpio_set(tms_gpio) : gpio_clear(tms_gpio);
 	tdi ? gpio_set(tdi_gpio) : gpio_clear(tdi_gpio);
 	tck ? gpio_set(tck_gpio) : gpio_clear(tck_gpio);
 
-	for (unsigned int i = 0; i < jtag_delay; i++)
-		asm volatile ("");
+	imx_gpio_delay();
+
+	return ERROR_OK;
+}
+
+/* Burst mode, only used when TCK, TMS and TDI share one GPIO bank: the bank's
+ * data register is read once per sequence and then every edge is a single
+ * store of the precomputed value instead of one read-modify-write per pin.
+ * Other outputs of that bank must not be changed behind our back meanwhile. */
+static int imx_gpio_scan_bits(const uint8_t *tms, const uint8_t *tdi,
+		uint8_t *tdo, unsigned num_bits)
+{
+	volatile struct imx_gpio_regs *jtag_bank = &pio_base[tck_gpio / 32];
+	volatile struct imx_gpio_regs *tdo_bank = &pio_base[tdo_gpio / 32];
+	const uint32_t tck_mask = 1u << (tck_gpio & 0x1F);
+	const uint32_t tms_mask = 1u << (tms_gpio & 0x1F);
+	const uint32_t tdi_mask = 1u << (tdi_gpio & 0x1F);
+	const uint32_t tdo_mask = 1u << (tdo_gpio & 0x1F);
+	uint32_t dr = jtag_bank->dr;
+
+	for (unsigned i = 0; i < num_bits; i++) {
+		uint8_t bit = 1 << (i % 8);
+
+		/* falling edge of TCK, TMS and TDI change with it */
+		dr &= ~(tck_mask | tms_mask | tdi_mask);
+		if (tms && (tms[i / 8] & bit))
+			dr |= tms_mask;
+		if (tdi && (tdi[i / 8] & bit))
+			dr |= tdi_mask;
+		jtag_bank->dr = dr;
+		imx_gpio_delay();
+
+		if (tdo) {
+			if (tdo_bank->dr & tdo_mask)
+				tdo[i / 8] |= bit;
+			else
+				tdo[i / 8] &= ~bit;
+		}
+
+		/* rising edge of TCK, nothing else changes */
+		dr |= tck_mask;
+		jtag_bank->dr = dr;
+		imx_gpio_delay();
+	}
+
+	/* leave TCK and TDI low, TMS keeps its last value */
+	dr &= ~(tck_mask | tdi_mask);
+	jtag_bank->dr = dr;
+	imx_gpio_delay();
 
 	return ERROR_OK;
 }
@@ -150,8 +203,7 @@ static int imx_gpio_swd_write(int tck, int tms, int tdi)
 	tdi ? gpio_set(swdio_gpio) : gpio_clear(swdio_gpio);
 	tck ? gpio_set(swclk_gpio) : gpio_clear(swclk_gpio);
 
-	for (unsigned int i = 0; i < jtag_delay; i++)
-		asm volatile ("");
+	imx_gpio_delay();
 
 	return ERROR_OK;
 }
@@ -529,6 +581,12 @@ static int imx_gpio_init(void)
 		  "tdo %d trst %d srst %d", tck_gpio_mode, tms_gpio_mode,
 		  tdi_gpio_mode, tdo_gpio_mode, trst_gpio_mode, srst_gpio_mode);
 
+	if (imx_gpio_jtag_mode_possible() && !swd_mode &&
+			tck_gpio / 32 == tms_gpio / 32 && tck_gpio / 32 == tdi_gpio / 32)
+		imx_gpio_bitbang.scan_bits = imx_gpio_scan_bits;
+	else
+		imx_gpio_bitbang.scan_bits = NULL;
+
 	if (swd_mode) {
 		imx_gpio_bitbang.write = imx_gpio_swd_write;
 		bitbang_switch_to_swd();
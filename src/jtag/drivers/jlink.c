@@ -89,6 +89,7 @@ static void jlink_stableclocks(int num_cycles);
 static void jlink_runtest(int num_cycles);
 static void jlink_reset(int trst, int srst);
 static int jlink_swd_run_queue(void);
+static int jlink_swd_flush(void);
 static void jlink_swd_queue_cmd(uint8_t cmd, uint32_t *dst, uint32_t data, uint32_t ap_delay_clk);
 static int jlink_swd_switch_seq(enum swd_special_seq seq);
 
@@ -117,6 +118,28 @@ static void jlink_clock_data(const uint8_t *out, unsigned out_offset,
 static enum tap_state jlink_last_state = TAP_RESET;
 static int queued_retval;
 
+/* Device round trips and bits transferred for the JTAG queue or SWD queue
+ * currently being executed, including intermediate flushes. JTAG and SWD
+ * are counted apart, so a report never includes the other's traffic. */
+struct jlink_round_trips {
+	unsigned int count;
+	unsigned int bits;
+};
+
+static struct jlink_round_trips jtag_round_trips;
+static struct jlink_round_trips swd_round_trips;
+
+static void jlink_log_round_trip_stats(const char *what,
+		struct jlink_round_trips *round_trips)
+{
+	if (round_trips->count)
+		LOG_DEBUG("%s: %u round trip(s), %u bits.", what,
+			round_trips->count, round_trips->bits);
+
+	round_trips->count = 0;
+	round_trips->bits = 0;
+}
+
 /***************************************************************************/
 /* External interface implementation */
 
@@ -308,7 +331,10 @@ static int jlink_execute_queue(void)
 		cmd = cmd->next;
 	}
 
-	return jlink_flush();
+	ret = jlink_flush();
+	jlink_log_round_trip_stats("JTAG queue", &jtag_round_trips);
+
+	return ret;
 }
 
 static int jlink_speed(int speed)
@@ -1916,17 +1942,21 @@ struct pending_scan_result {
 	unsigned buffer_offset;
 };
 
-#define MAX_PENDING_SCAN_RESULTS 256
+/* Enough to fill a whole buffer with minimal (46 bit) SWD transactions. */
+#define MAX_PENDING_SCAN_RESULTS (JLINK_TAP_BUFFER_SIZE * 8 / 46 + 1)
 
 static int pending_scan_results_length;
 static struct pending_scan_result pending_scan_results_buffer[MAX_PENDING_SCAN_RESULTS];
 
 static void jlink_tap_init(void)
 {
+	/* Only clear the part used by the last transfer, everything behind
+	 * tap_length is still zero. */
+	memset(tms_buffer, 0, DIV_ROUND_UP(tap_length, 8));
+	memset(tdi_buffer, 0, DIV_ROUND_UP(tap_length, 8));
+
 	tap_length = 0;
 	pending_scan_results_length = 0;
-	memset(tms_buffer, 0, sizeof(tms_buffer));
-	memset(tdi_buffer, 0, sizeof(tdi_buffer));
 }
 
 static void jlink_clock_data(const uint8_t *out, unsigned out_offset,
@@ -1984,6 +2014,8 @@ static int jlink_flush(void)
 
 	ret = jaylink_jtag_io(devh, tms_buffer, tdi_buffer, tdo_buffer,
 		tap_length, jtag_command_version);
+	jtag_round_trips.count++;
+	jtag_round_trips.bits += tap_length;
 
 	if (ret != JAYLINK_OK) {
 		LOG_ERROR("jaylink_jtag_io() failed: %s.", jaylink_strerror(ret));
@@ -2071,7 +2103,7 @@ static int jlink_swd_switch_seq(enum swd_special_seq seq)
 	return ERROR_OK;
 }
 
-static int jlink_swd_run_queue(void)
+static int jlink_swd_flush(void)
 {
 	int i;
 	int ret;
@@ -2090,6 +2122,8 @@ static int jlink_swd_run_queue(void)
 	jlink_queue_data_out(NULL, 8);
 
 	ret = jaylink_swd_io(devh, tms_buffer, tdi_buffer, tdo_buffer, tap_length);
+	swd_round_trips.count++;
+	swd_round_trips.bits += tap_length;
 
 	if (ret != JAYLINK_OK) {
 		LOG_ERROR("jaylink_swd_io() failed: %s.", jaylink_strerror(ret));
@@ -2127,13 +2161,22 @@ skip:
 	return ret;
 }
 
+static int jlink_swd_run_queue(void)
+{
+	int ret = jlink_swd_flush();
+
+	jlink_log_round_trip_stats("SWD queue", &swd_round_trips);
+
+	return ret;
+}
+
 static void jlink_swd_queue_cmd(uint8_t cmd, uint32_t *dst, uint32_t data, uint32_t ap_delay_clk)
 {
 	uint8_t data_parity_trn[DIV_ROUND_UP(32 + 1, 8)];
-	if (tap_length + 46 + 8 + ap_delay_clk >= sizeof(tdi_buffer) * 8 ||
+	if (tap_length + 46 + 8 + ap_delay_clk >= swd_buffer_size * 8 ||
 	    pending_scan_results_length == MAX_PENDING_SCAN_RESULTS) {
 		/* Not enough room in the queue. Run the queue. */
-		queued_retval = jlink_swd_run_queue();
+		queued_retval = jlink_swd_flush();
 	}
 
 	if (queued_retval != ERROR_OK)
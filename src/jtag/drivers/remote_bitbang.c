@@ -30,6 +30,9 @@
 /* arbitrary limit on host name length: */
 #define REMOTE_BITBANG_HOST_MAX 255
 
+/* maximum number of bits clocked per block by remote_bitbang_scan_bits() */
+#define REMOTE_BITBANG_SCAN_CHUNK 4096
+
 static char *remote_bitbang_host;
 static char *remote_bitbang_port;
 
@@ -176,10 +179,92 @@ static bb_value_t remote_bitbang_read_sample(void)
 	return remote_bitbang_rread();
 }
 
+static char remote_bitbang_write_char(int tck, int tms, int tdi)
+{
+	return '0' + ((tck ? 0x4 : 0x0) | (tms ? 0x2 : 0x0) | (tdi ? 0x1 : 0x0));
+}
+
 static int remote_bitbang_write(int tck, int tms, int tdi)
 {
-	char c = '0' + ((tck ? 0x4 : 0x0) | (tms ? 0x2 : 0x0) | (tdi ? 0x1 : 0x0));
-	return remote_bitbang_putc(c);
+	return remote_bitbang_putc(remote_bitbang_write_char(tck, tms, tdi));
+}
+
+/* Read exactly count bytes of read responses, blocking as needed. */
+static int remote_bitbang_read_responses(char *buf, size_t count)
+{
+	if (EOF == fflush(remote_bitbang_file)) {
+		remote_bitbang_quit();
+		LOG_ERROR("fflush: %s", strerror(errno));
+		return ERROR_FAIL;
+	}
+
+	/* Enable blocking access. */
+	socket_block(remote_bitbang_fd);
+	while (count > 0) {
+		ssize_t n = read(remote_bitbang_fd, buf, count);
+		if (n <= 0) {
+			remote_bitbang_quit();
+			LOG_ERROR("read: count=%d, error=%s", (int) n, strerror(errno));
+			return ERROR_FAIL;
+		}
+		buf += n;
+		count -= n;
+	}
+
+	return ERROR_OK;
+}
+
+/* Clock a whole bit sequence. Write commands are sent in blocks of at most
+ * REMOTE_BITBANG_SCAN_CHUNK bits, so that the remote side never has to queue
+ * more than that many read responses before we collect them all at once. */
+static int remote_bitbang_scan_bits(const uint8_t *tms, const uint8_t *tdi,
+		uint8_t *tdo, unsigned num_bits)
+{
+	static char cmd_buf[REMOTE_BITBANG_SCAN_CHUNK * 3];
+	static char resp_buf[REMOTE_BITBANG_SCAN_CHUNK];
+	int tms_bit = 0;
+
+	for (unsigned offset = 0; offset < num_bits; offset += REMOTE_BITBANG_SCAN_CHUNK) {
+		unsigned chunk = MIN(num_bits - offset, REMOTE_BITBANG_SCAN_CHUNK);
+		char *p = cmd_buf;
+
+		for (unsigned i = offset; i < offset + chunk; i++) {
+			int tdi_bit = tdi && (tdi[i / 8] & (1 << (i % 8))) ? 1 : 0;
+			tms_bit = tms && (tms[i / 8] & (1 << (i % 8))) ? 1 : 0;
+
+			*p++ = remote_bitbang_write_char(0, tms_bit, tdi_bit);
+			if (tdo)
+				*p++ = 'R';
+			*p++ = remote_bitbang_write_char(1, tms_bit, tdi_bit);
+		}
+
+		if (fwrite(cmd_buf, 1, p - cmd_buf, remote_bitbang_file) != (size_t)(p - cmd_buf)) {
+			LOG_ERROR("remote_bitbang_scan_bits: %s", strerror(errno));
+			return ERROR_FAIL;
+		}
+
+		if (!tdo)
+			continue;
+
+		if (remote_bitbang_read_responses(resp_buf, chunk) != ERROR_OK)
+			return ERROR_FAIL;
+
+		for (unsigned i = 0; i < chunk; i++) {
+			unsigned bit = offset + i;
+			switch (char_to_int(resp_buf[i])) {
+				case BB_LOW:
+					tdo[bit / 8] &= ~(1 << (bit % 8));
+					break;
+				case BB_HIGH:
+					tdo[bit / 8] |= 1 << (bit % 8);
+					break;
+				default:
+					return ERROR_FAIL;
+			}
+		}
+	}
+
+	return remote_bitbang_write(0, tms_bit, 0);
 }
 
 static int remote_bitbang_reset(int trst, int srst)
@@ -199,6 +284,7 @@ static struct bitbang_interface remote_bitbang_bitbang = {
 	.sample = &remote_bitbang_sample,
 	.read_sample = &remote_bitbang_read_sample,
 	.write = &remote_bitbang_write,
+	.scan_bits = &remote_bitbang_scan_bits,
 	.reset = &remote_bitbang_reset,
 	.blink = &remote_bitbang_blink,
 };
@@ -95,6 +95,12 @@
  * BUF_LEN must be grater than or equal MAX_PACKET_SIZE.
  */
 #define BUF_LEN 4096
+/*
+ * Maximum number of TDO bytes left pending in the USB-Blaster before the host
+ * reads them back. The FT245 read FIFO is 384 bytes deep: staying below it
+ * ensures the dongle never stalls on a full read FIFO while we keep writing.
+ */
+#define MAX_PENDING_TDOS 256
 
 /* USB-Blaster II specific command */
 #define CMD_COPY_TDO_BUFFER	0x5F
@@ -106,6 +112,19 @@ enum gpio_steer {
 	TRST,
 };
 
+/* A TDO read back queued in the dongle, not yet collected by the host */
+struct ublast_pending_read {
+	uint8_t *buf;
+	int nb;			/* number of bytes (byteshift) or bits (bitbang) */
+	bool bitbang;
+};
+
+/* A scan waiting for its TDO bits before its fields can be filled in */
+struct ublast_pending_scan {
+	struct scan_command *cmd;
+	uint8_t *buf;
+};
+
 struct ublast_info {
 	enum gpio_steer pin6;
 	enum gpio_steer pin8;
@@ -116,6 +135,13 @@ struct ublast_info {
 	uint8_t buf[BUF_LEN];
 	int bufidx;
 
+	struct ublast_pending_read reads[MAX_PENDING_TDOS];
+	int nb_reads;
+	int nb_pending_tdos;
+	struct ublast_pending_scan *scans;
+	int nb_scans;
+	int max_scans;
+
 	char *lowlevel_name;
 	struct ublast_lowlevel *drv;
 	char *ublast_device_desc;
@@ -523,71 +549,111 @@ static void ublast_state_move(tap_state_t state, int skip)
 }
 
 /**
- * ublast_read_byteshifted_tdos - read TDO of byteshift writes
- * @buf: the buffer to store the bits
- * @nb_bits: the number of bits
+ * ublast_read_tdos - collect all TDO bits pending in the USB Blaster
  *
- * Reads back from USB Blaster TDO bits, triggered by a 'byteshift write', ie. eight
- * bits per received byte from USB interface, and store them in buffer.
+ * Flushes the write buffer, then reads back in a single batch every TDO byte
+ * triggered by the queued byteshift and bitbang writes, and dispatches them to
+ * the buffers registered with ublast_queue_tdos().
  *
- * As the USB blaster stores the TDO bits in LSB (ie. first bit in (byte0,
- * bit0), second bit in (byte0, bit1), ...), which is what we want to return,
- * simply read bytes from USB interface and store them.
+ * For byteshift reads, the USB blaster stores the TDO bits in LSB (ie. first
+ * bit in (byte0, bit0), second bit in (byte0, bit1), ...), which is what we
+ * want to return, so the bytes are simply copied.
+ *
+ * For bitbang reads, there is one bit per received byte from USB interface,
+ * which is stored in the buffer where :
+ *  - first bit is stored in byte0, bit0 (LSB)
+ *  - second bit is stored in byte0, bit 1
+ *  ...
+ *  - eight bit is stored in byte0, bit 7
  *
  * Returns ERROR_OK if OK, ERROR_xxx if a read error occured
  */
-static int ublast_read_byteshifted_tdos(uint8_t *buf, int nb_bytes)
+static int ublast_read_tdos(void)
 {
+	static uint8_t tdos[MAX_PENDING_TDOS];
+	struct ublast_pending_read *read;
 	unsigned int retlen;
-	int ret = ERROR_OK;
+	int i, j, nb = 0, ret = ERROR_OK;
+	uint8_t *p = tdos;
+
+	if (info.nb_pending_tdos == 0)
+		return ERROR_OK;
+
+	DEBUG_JTAG_IO("%s(nb_reads=%d, nb_bytes=%d)", __func__, info.nb_reads,
+		      info.nb_pending_tdos);
 
-	DEBUG_JTAG_IO("%s(buf=%p, num_bits=%d)", __func__, buf, nb_bytes * 8);
+	/*
+	 * Ensure all previous writes were issued to the dongle, so that it
+	 * returns back the read values.
+	 */
 	ublast_flush_buffer();
-	while (ret == ERROR_OK && nb_bytes > 0) {
-		ret = ublast_buf_read(buf, nb_bytes, &retlen);
-		nb_bytes -= retlen;
+
+	while (ret == ERROR_OK && nb < info.nb_pending_tdos) {
+		ret = ublast_buf_read(tdos + nb, info.nb_pending_tdos - nb, &retlen);
+		if (ret == ERROR_OK && retlen == 0) {
+			LOG_ERROR("timeout reading back %d TDO bytes",
+				  info.nb_pending_tdos - nb);
+			ret = ERROR_JTAG_DEVICE_ERROR;
+		}
+		nb += retlen;
 	}
+
+	for (i = 0; ret == ERROR_OK && i < info.nb_reads; i++) {
+		read = &info.reads[i];
+		if (read->bitbang) {
+			for (j = 0; j < read->nb; j++)
+				if (p[j] & READ_TDO)
+					*read->buf |= (1 << j);
+				else
+					*read->buf &= ~(1 << j);
+		} else {
+			memcpy(read->buf, p, read->nb);
+		}
+		p += read->nb;
+	}
+
+	info.nb_reads = 0;
+	info.nb_pending_tdos = 0;
 	return ret;
 }
 
 /**
- * ublast_read_bitbang_tdos - read TDO of bitbang writes
- * @buf: the buffer to store the bits
- * @nb_bits: the number of bits
+ * ublast_reserve_tdos - make room for TDO bytes in the USB Blaster
+ * @nb_bytes: the number of TDO bytes about to be requested
  *
- * Reads back from USB Blaster TDO bits, triggered by a 'bitbang write', ie. one
- * bit per received byte from USB interface, and store them in buffer, where :
- *  - first bit is stored in byte0, bit0 (LSB)
- *  - second bit is stored in byte0, bit 1
- *  ...
- *  - eight bit is sotred in byte0, bit 7
- *  - ninth bit is sotred in byte1, bit 0
- *  - etc ...
+ * Collects the pending TDO reads if requesting @nb_bytes more would overflow
+ * the dongle read FIFO.
  *
  * Returns ERROR_OK if OK, ERROR_xxx if a read error occured
  */
-static int ublast_read_bitbang_tdos(uint8_t *buf, int nb_bits)
+static int ublast_reserve_tdos(int nb_bytes)
 {
-	int nb1 = nb_bits;
-	int i, ret = ERROR_OK;
-	unsigned int retlen;
-	uint8_t tmp[8];
-
-	DEBUG_JTAG_IO("%s(buf=%p, num_bits=%d)", __func__, buf, nb_bits);
-
-	/*
-	 * Ensure all previous bitbang writes were issued to the dongle, so that
-	 * it returns back the read values.
-	 */
-	ublast_flush_buffer();
+	if (info.nb_pending_tdos + nb_bytes <= MAX_PENDING_TDOS)
+		return ERROR_OK;
+	return ublast_read_tdos();
+}
 
-	ret = ublast_buf_read(tmp, nb1, &retlen);
-	for (i = 0; ret == ERROR_OK && i < nb1; i++)
-		if (tmp[i] & READ_TDO)
-			*buf |= (1 << i);
-		else
-			*buf &= ~(1 << i);
-	return ret;
+/**
+ * ublast_queue_tdos - register a TDO read back
+ * @buf: the buffer to store the bits
+ * @nb: the number of bytes (byteshift mode) or bits (bitbang mode, up to 8)
+ * @bitbang: true if the TDOs were triggered by bitbang writes
+ *
+ * The read is deferred until ublast_read_tdos() is called, either because the
+ * dongle read FIFO is getting full, or at the end of the JTAG queue. The
+ * caller must have called ublast_reserve_tdos() before queuing the writes
+ * triggering these TDOs.
+ */
+static void ublast_queue_tdos(uint8_t *buf, int nb, bool bitbang)
+{
+	struct ublast_pending_read *read = &info.reads[info.nb_reads++];
+
+	read->buf = buf;
+	read->nb = nb;
+	read->bitbang = bitbang;
+	info.nb_pending_tdos += nb;
+	if (info.flags & COPY_TDO_BUFFER)
+		ublast_queue_byte(CMD_COPY_TDO_BUFFER);
 }
 
 /**
@@ -600,21 +666,24 @@ static int ublast_read_bitbang_tdos(uint8_t *buf, int nb_bits)
  * As a side effect, the last TDI bit is sent along a TMS=1, and triggers a JTAG
  * TAP state shift if input bits were non NULL.
  *
- * In order to not saturate the USB Blaster queues, this method reads back TDO
- * if the scan type requests it, and stores them back in bits.
+ * If the scan type requests it, the TDO bits will be stored back in bits. The
+ * reads are deferred : bits may only be used once ublast_read_tdos() has been
+ * called.
  *
  * As a side note, the state of TCK when entering this function *must* be
  * low. This is because byteshift mode outputs TDI on rising TCK and reads TDO
  * on falling TCK if and only if TCK is low before queuing byteshift mode bytes.
  * If TCK was high, the USB blaster will queue TDI on falling edge, and read TDO
  * on rising edge !!!
+ *
+ * Returns ERROR_OK if OK, ERROR_xxx if a read error occured
  */
-static void ublast_queue_tdi(uint8_t *bits, int nb_bits, enum scan_type scan)
+static int ublast_queue_tdi(uint8_t *bits, int nb_bits, enum scan_type scan)
 {
 	int nb8 = nb_bits / 8;
 	int nb1 = nb_bits % 8;
 	int nbfree_in_packet, i, trans = 0, read_tdos;
-	uint8_t *tdos = calloc(1, nb_bits / 8 + 1);
+	int ret = ERROR_OK;
 	static uint8_t byte0[BUF_LEN];
 
 	/*
@@ -625,14 +694,21 @@ static void ublast_queue_tdi(uint8_t *bits, int nb_bits, enum scan_type scan)
 	 *   nb_bits
 	 * - nb1 = 8
 	 * This ensures that nb1 is never 0, and allows the TMS transition.
+	 * Without input bits (runtest, stableclocks), there is no transition
+	 * and all the whole bytes are shifted out in "byteshift mode".
 	 */
-	if (nb8 > 0 && nb1 == 0) {
+	if (bits && nb8 > 0 && nb1 == 0) {
 		nb8--;
 		nb1 = 8;
 	}
 
 	read_tdos = (scan == SCAN_IN || scan == SCAN_IO);
-	for (i = 0; i < nb8; i += trans) {
+	for (i = 0; ret == ERROR_OK && i < nb8; i += trans) {
+		if (read_tdos)
+			ret = ublast_reserve_tdos(MIN(MAX_PACKET_SIZE - 1, nb8 - i));
+		if (ret != ERROR_OK)
+			break;
+
 		/*
 		 * Calculate number of bytes to fill USB packet of size MAX_PACKET_SIZE
 		 */
@@ -653,16 +729,18 @@ static void ublast_queue_tdi(uint8_t *bits, int nb_bits, enum scan_type scan)
 			ublast_queue_bytes(&bits[i], trans);
 		else
 			ublast_queue_bytes(byte0, trans);
-		if (read_tdos) {
-			if (info.flags & COPY_TDO_BUFFER)
-				ublast_queue_byte(CMD_COPY_TDO_BUFFER);
-			ublast_read_byteshifted_tdos(&tdos[i], trans);
-		}
+		if (read_tdos)
+			ublast_queue_tdos(&bits[i], trans, false);
 	}
 
 	/*
 	 * Queue the remaining TDI bits in bitbang mode.
 	 */
+	if (ret == ERROR_OK && nb1 && read_tdos)
+		ret = ublast_reserve_tdos(nb1);
+	if (ret != ERROR_OK)
+		return ret;
+
 	for (i = 0; i < nb1; i++) {
 		int tdi = bits ? bits[nb8 + i / 8] & (1 << i) : 0;
 		if (bits && i == nb1 - 1)
@@ -670,20 +748,14 @@ static void ublast_queue_tdi(uint8_t *bits, int nb_bits, enum scan_type scan)
 		else
 			ublast_clock_tdi(tdi, scan);
 	}
-	if (nb1 && read_tdos) {
-		if (info.flags & COPY_TDO_BUFFER)
-			ublast_queue_byte(CMD_COPY_TDO_BUFFER);
-		ublast_read_bitbang_tdos(&tdos[nb8], nb1);
-	}
-
-	if (bits)
-		memcpy(bits, tdos, DIV_ROUND_UP(nb_bits, 8));
-	free(tdos);
+	if (nb1 && read_tdos)
+		ublast_queue_tdos(&bits[nb8], nb1, true);
 
 	/*
 	 * Ensure clock is in lower state
 	 */
 	ublast_idle_clock();
+	return ERROR_OK;
 }
 
 static void ublast_runtest(int cycles, tap_state_t state)
@@ -701,6 +773,56 @@ static void ublast_stableclocks(int cycles)
 	ublast_queue_tdi(NULL, cycles, SCAN_OUT);
 }
 
+/**
+ * ublast_queue_scan_result - defer the read back of a scan
+ * @cmd: the scan command
+ * @buf: the scan buffer, which will receive the TDO bits
+ *
+ * The scan fields are filled in by ublast_read_scan_results(), once all the
+ * TDO bits of the JTAG queue are collected. The buffer is freed afterwards.
+ *
+ * Returns ERROR_OK if OK, ERROR_FAIL if out of memory
+ */
+static int ublast_queue_scan_result(struct scan_command *cmd, uint8_t *buf)
+{
+	struct ublast_pending_scan *scans;
+
+	if (info.nb_scans == info.max_scans) {
+		scans = realloc(info.scans, (info.max_scans + 32) * sizeof(*scans));
+		if (!scans) {
+			LOG_ERROR("Out of memory");
+			ublast_read_tdos();
+			free(buf);
+			return ERROR_FAIL;
+		}
+		info.scans = scans;
+		info.max_scans += 32;
+	}
+	info.scans[info.nb_scans].cmd = cmd;
+	info.scans[info.nb_scans].buf = buf;
+	info.nb_scans++;
+	return ERROR_OK;
+}
+
+/**
+ * ublast_read_scan_results - collect TDO bits and fill in the deferred scans
+ *
+ * Returns ERROR_OK if OK, ERROR_xxx if a read error occured
+ */
+static int ublast_read_scan_results(void)
+{
+	int i, ret;
+
+	ret = ublast_read_tdos();
+	for (i = 0; i < info.nb_scans; i++) {
+		if (ret == ERROR_OK)
+			ret = jtag_read_buffer(info.scans[i].buf, info.scans[i].cmd);
+		free(info.scans[i].buf);
+	}
+	info.nb_scans = 0;
+	return ret;
+}
+
 /**
  * ublast_scan - launches a DR-scan or IR-scan
  * @cmd: the command to launch
@@ -733,10 +855,11 @@ static int ublast_scan(struct scan_command *cmd)
 		  scan_bits, log_buf, cmd->end_state);
 	free(log_buf);
 
-	ublast_queue_tdi(buf, scan_bits, type);
+	ret = ublast_queue_tdi(buf, scan_bits, type);
 
-	ret = jtag_read_buffer(buf, cmd);
-	if (buf)
+	if (ret == ERROR_OK && (type == SCAN_IN || type == SCAN_IO))
+		ret = ublast_queue_scan_result(cmd, buf);
+	else
 		free(buf);
 	/*
 	 * ublast_queue_tdi sends the last bit with TMS=1. We are therefore
@@ -781,7 +904,7 @@ static int ublast_execute_queue(void)
 {
 	struct jtag_command *cmd;
 	static int first_call = 1;
-	int ret = ERROR_OK;
+	int ret = ERROR_OK, read_ret;
 
 	if (first_call) {
 		first_call--;
@@ -819,7 +942,14 @@ static int ublast_execute_queue(void)
 		}
 	}
 
+	/*
+	 * All the scans of the queue were coalesced in the write buffer: read
+	 * back their TDOs in one batch now.
+	 */
 	ublast_flush_buffer();
+	read_ret = ublast_read_scan_results();
+	if (ret == ERROR_OK)
+		ret = read_ret;
 	return ret;
 }
 
@@ -900,6 +1030,9 @@ static int ublast_quit(void)
 	unsigned int retlen;
 
 	ublast_buf_write(&byte0, 1, &retlen);
+	free(info.scans);
+	info.scans = NULL;
+	info.max_scans = 0;
 	return info.drv->close(info.drv);
 }
 
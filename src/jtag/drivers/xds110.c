@@ -171,6 +171,9 @@
 #define CMD_RUNTEST      3
 #define CMD_STABLECLOCKS 4
 
+/* Marks that the JTAG request queue has no request that can be merged */
+#define NO_LAST_REQUEST 0xffffffff
+
 /* Array to convert from OpenOCD tap_state_t to XDS JTAG state */
 const uint32_t xds_jtag_state[] = {
 	XDS_JTAG_STATE_EXIT2_DR,   /* TAP_DREXIT2   = 0x0 */
@@ -229,6 +232,10 @@ struct xds110_info {
 	uint32_t txn_request_size;
 	uint32_t txn_result_size;
 	uint32_t txn_result_count;
+	/* Offset of the last queued JTAG request, for merging */
+	uint32_t txn_last_request;
+	/* Firmware round trips since the last queue execution */
+	uint32_t round_trips;
 };
 
 static struct xds110_info xds110 = {
@@ -246,7 +253,9 @@ static struct xds110_info xds110 = {
 	.hardware = 0,
 	.txn_request_size = 0,
 	.txn_result_size = 0,
-	.txn_result_count = 0
+	.txn_result_count = 0,
+	.txn_last_request = NO_LAST_REQUEST,
+	.round_trips = 0
 };
 
 static inline void xds110_set_u32(uint8_t *buffer, uint32_t value)
@@ -587,6 +596,7 @@ static bool xds_execute(uint32_t out_length, uint32_t in_length,
 
 	while (!done && attempts > 0) {
 		attempts--;
+		xds110.round_trips++;
 
 		/* Send command to XDS110 */
 		success = usb_send_command(out_length);
@@ -618,6 +628,14 @@ static bool xds_execute(uint32_t out_length, uint32_t in_length,
 	return success;
 }
 
+/* Log and reset the firmware round trips of the queue just executed */
+static void xds110_log_round_trips(const char *what)
+{
+	LOG_DEBUG("XDS110: %s queue took %" PRIu32 " firmware round trip(s)",
+		what, xds110.round_trips);
+	xds110.round_trips = 0;
+}
+
 static bool xds_connect(void)
 {
 	bool success;
@@ -1245,6 +1263,9 @@ static int xds110_swd_run_queue(void)
 	xds110.txn_request_size = 0;
 	xds110.txn_result_size = 0;
 	xds110.txn_result_count = 0;
+	xds110.txn_last_request = NO_LAST_REQUEST;
+
+	xds110_log_round_trips("SWD");
 
 	return (success) ? ERROR_OK : ERROR_FAIL;
 }
@@ -1542,6 +1563,7 @@ static void xds110_flush(void)
 	xds110.txn_request_size = 0;
 	xds110.txn_result_size = 0;
 	xds110.txn_result_count = 0;
+	xds110.txn_last_request = NO_LAST_REQUEST;
 }
 
 static void xds110_execute_reset(struct jtag_command *cmd)
@@ -1646,19 +1668,20 @@ static void xds110_queue_scan(struct jtag_command *cmd)
 	total_bytes = DIV_ROUND_UP(total_bits, 8);
 
 	/* Check if new request would be too large to fit */
-	if (((xds110.txn_request_size + 1 + total_bytes + sizeof(end_state) + 1)
+	if (((xds110.txn_request_size + 1 + sizeof(end_state) + 2 + total_bytes + 1)
 		> MAX_DATA_BLOCK) || ((xds110.txn_result_count + total_fields) >
 		MAX_RESULT_QUEUE))
 		xds110_flush();
 
 	/* Check if this single request is too large to fit */
-	if ((1 + total_bytes + sizeof(end_state) + 1) > MAX_DATA_BLOCK) {
+	if ((1 + sizeof(end_state) + 2 + total_bytes + 1) > MAX_DATA_BLOCK) {
 		LOG_ERROR("BUG: JTAG scan request is too large to handle (%d bits)",
 			total_bits);
 		/* Failing to run this scan mucks up debug on this target */
 		exit(-1);
 	}
 
+	xds110.txn_last_request = xds110.txn_request_size;
 	if (cmd->cmd.scan->ir_scan)
 		xds110.txn_requests[xds110.txn_request_size++] = CMD_IR_SCAN;
 	else
@@ -1695,17 +1718,53 @@ static void xds110_queue_scan(struct jtag_command *cmd)
 	return;
 }
 
+/*
+ * Try to fold a new runtest or stableclocks request into the directly
+ * preceding request of the same kind, saving queue space and firmware work.
+ * A runtest can only absorb the next one if it ends in IDLE, because the
+ * firmware moves to IDLE before clocking anyway.
+ */
+static bool xds110_merge_clocks(uint8_t command, uint32_t clocks,
+	uint8_t end_state)
+{
+	uint8_t *last;
+	uint32_t last_clocks;
+
+	if (xds110.txn_last_request == NO_LAST_REQUEST)
+		return false;
+
+	last = &xds110.txn_requests[xds110.txn_last_request];
+	if (last[0] != command)
+		return false;
+	if (command == CMD_RUNTEST && last[5] != XDS_JTAG_STATE_IDLE)
+		return false;
+
+	last_clocks = xds110_get_u32(&last[1]);
+	if (last_clocks > UINT32_MAX - clocks)
+		return false;
+
+	xds110_set_u32(&last[1], last_clocks + clocks);
+	if (command == CMD_RUNTEST)
+		last[5] = end_state;
+
+	return true;
+}
+
 static void xds110_queue_runtest(struct jtag_command *cmd)
 {
 	uint32_t clocks = (uint32_t)cmd->cmd.stableclocks->num_cycles;
 	uint8_t end_state = (uint8_t)xds_jtag_state[cmd->cmd.runtest->end_state];
 
+	if (xds110_merge_clocks(CMD_RUNTEST, clocks, end_state))
+		return;
+
 	/* Check if new request would be too large to fit */
 	if ((xds110.txn_request_size + 1 + sizeof(clocks) + sizeof(end_state) + 1)
 		> MAX_DATA_BLOCK)
 		xds110_flush();
 
 	/* Queue request and cycle count directly to queue buffer */
+	xds110.txn_last_request = xds110.txn_request_size;
 	xds110.txn_requests[xds110.txn_request_size++] = CMD_RUNTEST;
 	xds110.txn_requests[xds110.txn_request_size++] = (clocks >>  0) & 0xff;
 	xds110.txn_requests[xds110.txn_request_size++] = (clocks >>  8) & 0xff;
@@ -1720,11 +1779,15 @@ static void xds110_queue_stableclocks(struct jtag_command *cmd)
 {
 	uint32_t clocks = (uint32_t)cmd->cmd.stableclocks->num_cycles;
 
+	if (xds110_merge_clocks(CMD_STABLECLOCKS, clocks, 0))
+		return;
+
 	/* Check if new request would be too large to fit */
 	if ((xds110.txn_request_size + 1 + sizeof(clocks) + 1) > MAX_DATA_BLOCK)
 		xds110_flush();
 
 	/* Queue request and cycle count directly to queue buffer */
+	xds110.txn_last_request = xds110.txn_request_size;
 	xds110.txn_requests[xds110.txn_request_size++] = CMD_STABLECLOCKS;
 	xds110.txn_requests[xds110.txn_request_size++] = (clocks >>  0) & 0xff;
 	xds110.txn_requests[xds110.txn_request_size++] = (clocks >>  8) & 0xff;
@@ -1781,6 +1844,8 @@ static int xds110_execute_queue(void)
 
 	xds110_flush();
 
+	xds110_log_round_trips("JTAG");
+
 	return ERROR_OK;
 }
 
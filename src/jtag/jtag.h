@@ -149,6 +149,9 @@ struct jtag_tap {
 	uint8_t *cur_instr;
 	/** Bypass register selected */
 	int bypass;
+	/** When set, IR and DR scans addressed to this TAP are also shifted
+	 * into this TAP; see jtag_tap_set_gang_leader() */
+	struct jtag_tap *gang_leader;
 
 	struct jtag_tap_event_action *event_action;
 
@@ -169,6 +172,16 @@ struct jtag_tap *jtag_tap_next_enabled(struct jtag_tap *p);
 unsigned jtag_tap_count_enabled(void);
 unsigned jtag_tap_count(void);
 
+/**
+ * Makes @a tap a member of the gang of @a leader, or removes it from its
+ * gang if @a leader is NULL.  Gang members receive the same instruction
+ * and data as their leader whenever a scan addresses the leader, so
+ * identical devices on one chain can be driven in lock step; only the
+ * leader's captured data is returned.  The IR of the chain is reloaded
+ * so that @a tap follows its new leader, or goes to BYPASS.
+ */
+int jtag_tap_set_gang_leader(struct jtag_tap *tap, struct jtag_tap *leader);
+
 /*
  * - TRST_ASSERTED triggers two sets of callbacks, after operations to
  *   reset the scan chain -- via TMS+TCK signaling, or deasserting the
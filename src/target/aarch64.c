@@ -61,7 +61,8 @@ static int aarch64_mmu(struct target *target, int *enabled);
 static int aarch64_virt2phys(struct target *target,
 	target_addr_t virt, target_addr_t *phys);
 static int aarch64_read_cpu_memory(struct target *target,
-	uint64_t address, uint32_t size, uint32_t count, uint8_t *buffer);
+	uint64_t address, uint32_t size, uint32_t count, uint8_t *buffer,
+	bool as_buffer);
 
 #define foreach_smp_target(pos, head) \
 	for (pos = head; (pos != NULL); pos = pos->next)
@@ -1801,9 +1802,50 @@ static int aarch64_write_cpu_memory_fast(struct target *target,
 	return ERROR_OK;
 }
 
+static int aarch64_write_cpu_memory_buffer(struct target *target,
+	uint64_t address, uint32_t count, const uint8_t *buffer, uint32_t *dscr)
+{
+	/* Writes count bytes from *buffer with the access sizes that
+	 * target_write_buffer() would use, but without leaving the DCC session:
+	 * narrow stores for the unaligned head and tail, memory access mode for
+	 * the word-aligned middle. X0 is post-incremented by both paths. */
+	uint32_t size;
+	int retval;
+
+	for (size = 1; size < 4 && count >= size * 2 + (address & size); size *= 2) {
+		if (address & size) {
+			retval = aarch64_write_cpu_memory_slow(target, size, 1, buffer, dscr);
+			if (retval != ERROR_OK)
+				return retval;
+			address += size;
+			count -= size;
+			buffer += size;
+		}
+	}
+
+	for (; size > 0; size /= 2) {
+		uint32_t aligned = count - count % size;
+		if (aligned == 0)
+			continue;
+
+		if (size == 4)
+			retval = aarch64_write_cpu_memory_fast(target, aligned / 4, buffer, dscr);
+		else
+			retval = aarch64_write_cpu_memory_slow(target, size, aligned / size,
+					buffer, dscr);
+		if (retval != ERROR_OK)
+			return retval;
+
+		count -= aligned;
+		buffer += aligned;
+	}
+
+	return ERROR_OK;
+}
+
 static int aarch64_write_cpu_memory(struct target *target,
 	uint64_t address, uint32_t size,
-	uint32_t count, const uint8_t *buffer)
+	uint32_t count, const uint8_t *buffer, bool as_buffer)
 {
 	/* write memory through APB-AP */
 	int retval = ERROR_COMMAND_SYNTAX_ERROR;
@@ -1856,7 +1898,9 @@ static int aarch64_write_cpu_memory(struct target *target,
 	if (retval != ERROR_OK)
 		return retval;
 
-	if (size == 4 && (address % 4) == 0)
+	if (as_buffer)
+		retval = aarch64_write_cpu_memory_buffer(target, address, count, buffer, &dscr);
+	else if (size == 4 && (address % 4) == 0)
 		retval = aarch64_write_cpu_memory_fast(target, count, buffer, &dscr);
 	else
 		retval = aarch64_write_cpu_memory_slow(target, size, count, buffer, &dscr);
@@ -1900,7 +1944,7 @@ static int aarch64_read_cpu_memory_slow(struct target *target,
 
 	/* change DCC to normal mode (if necessary) */
 	if (*dscr & DSCR_MA) {
-		*dscr &= DSCR_MA;
+		*dscr &= ~DSCR_MA;
 		retval =  mem_ap_write_atomic_u32(armv8->debug_ap,
 				armv8->debug_base + CPUV8_DBG_DSCR, *dscr);
 		if (retval != ERROR_OK)
@@ -2016,9 +2060,50 @@ static int aarch64_read_cpu_memory_fast(struct target *target,
 	return retval;
 }
 
+static int aarch64_read_cpu_memory_buffer(struct target *target,
+	target_addr_t address, uint32_t count, uint8_t *buffer, uint32_t *dscr)
+{
+	/* Reads count bytes into *buffer with the access sizes that
+	 * target_read_buffer() would use, but without leaving the DCC session:
+	 * narrow loads for the unaligned head and tail, memory access mode for
+	 * the word-aligned middle. X0 is post-incremented by both paths. */
+	uint32_t size;
+	int retval;
+
+	for (size = 1; size < 4 && count >= size * 2 + (address & size); size *= 2) {
+		if (address & size) {
+			retval = aarch64_read_cpu_memory_slow(target, size, 1, buffer, dscr);
+			if (retval != ERROR_OK)
+				return retval;
+			address += size;
+			count -= size;
+			buffer += size;
+		}
+	}
+
+	for (; size > 0; size /= 2) {
+		uint32_t aligned = count - count % size;
+		if (aligned == 0)
+			continue;
+
+		if (size == 4)
+			retval = aarch64_read_cpu_memory_fast(target, aligned / 4, buffer, dscr);
+		else
+			retval = aarch64_read_cpu_memory_slow(target, size, aligned / size,
+					buffer, dscr);
+		if (retval != ERROR_OK)
+			return retval;
+
+		count -= aligned;
+		buffer += aligned;
+	}
+
+	return ERROR_OK;
+}
+
 static int aarch64_read_cpu_memory(struct target *target,
 	target_addr_t address, uint32_t size,
-	uint32_t count, uint8_t *buffer)
+	uint32_t count, uint8_t *buffer, bool as_buffer)
 {
 	/* read memory through APB-AP */
 	int retval = ERROR_COMMAND_SYNTAX_ERROR;
@@ -2074,7 +2159,9 @@ static int aarch64_read_cpu_memory(struct target *target,
 	if (retval != ERROR_OK)
 		return retval;
 
-	if (size == 4 && (address % 4) == 0)
+	if (as_buffer)
+		retval = aarch64_read_cpu_memory_buffer(target, address, count, buffer, &dscr);
+	else if (size == 4 && (address % 4) == 0)
 		retval = aarch64_read_cpu_memory_fast(target, count, buffer, &dscr);
 	else
 		retval = aarch64_read_cpu_memory_slow(target, size, count, buffer, &dscr);
@@ -2118,7 +2205,7 @@ static int aarch64_read_phys_memory(struct target *target,
 		retval = aarch64_mmu_modify(target, 0);
 		if (retval != ERROR_OK)
 			return retval;
-		retval = aarch64_read_cpu_memory(target, address, size, count, buffer);
+		retval = aarch64_read_cpu_memory(target, address, size, count, buffer, false);
 	}
 	return retval;
 }
@@ -2140,7 +2227,7 @@ static int aarch64_read_memory(struct target *target, target_addr_t address,
 		if (retval != ERROR_OK)
 			return retval;
 	}
-	return aarch64_read_cpu_memory(target, address, size, count, buffer);
+	return aarch64_read_cpu_memory(target, address, size, count, buffer, false);
 }
 
 static int aarch64_write_phys_memory(struct target *target,
@@ -2154,7 +2241,7 @@ static int aarch64_write_phys_memory(struct target *target,
 		retval = aarch64_mmu_modify(target, 0);
 		if (retval != ERROR_OK)
 			return retval;
-		return aarch64_write_cpu_memory(target, address, size, count, buffer);
+		return aarch64_write_cpu_memory(target, address, size, count, buffer, false);
 	}
 
 	return retval;
@@ -2177,7 +2264,53 @@ static int aarch64_write_memory(struct target *target, target_addr_t address,
 		if (retval != ERROR_OK)
 			return retval;
 	}
-	return aarch64_write_cpu_memory(target, address, size, count, buffer);
+	return aarch64_write_cpu_memory(target, address, size, count, buffer, false);
+}
+
+static int aarch64_read_buffer(struct target *target, target_addr_t address,
+	uint32_t count, uint8_t *buffer)
+{
+	int mmu_enabled = 0;
+	int retval;
+
+	if (!count)
+		return ERROR_OK;
+
+	/* determine if MMU was enabled on target stop */
+	retval = aarch64_mmu(target, &mmu_enabled);
+	if (retval != ERROR_OK)
+		return retval;
+
+	if (mmu_enabled) {
+		/* enable MMU as we could have disabled it for phys access */
+		retval = aarch64_mmu_modify(target, 1);
+		if (retval != ERROR_OK)
+			return retval;
+	}
+	return aarch64_read_cpu_memory(target, address, 1, count, buffer, true);
+}
+
+static int aarch64_write_buffer(struct target *target, target_addr_t address,
+	uint32_t count, const uint8_t *buffer)
+{
+	int mmu_enabled = 0;
+	int retval;
+
+	if (!count)
+		return ERROR_OK;
+
+	/* determine if MMU was enabled on target stop */
+	retval = aarch64_mmu(target, &mmu_enabled);
+	if (retval != ERROR_OK)
+		return retval;
+
+	if (mmu_enabled) {
+		/* enable MMU as we could have disabled it for phys access */
+		retval = aarch64_mmu_modify(target, 1);
+		if (retval != ERROR_OK)
+			return retval;
+	}
+	return aarch64_write_cpu_memory(target, address, 1, count, buffer, true);
 }
 
 static int aarch64_handle_target_request(void *priv)
@@ -2828,6 +2961,8 @@ struct target_type aarch64_target = {
 
 	.read_memory = aarch64_read_memory,
 	.write_memory = aarch64_write_memory,
+	.read_buffer = aarch64_read_buffer,
+	.write_buffer = aarch64_write_buffer,
 
 	.add_breakpoint = aarch64_add_breakpoint,
 	.add_context_breakpoint = aarch64_add_context_breakpoint,
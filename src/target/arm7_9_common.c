@@ -2512,6 +2512,9 @@ int arm7_9_write_memory_no_opt(struct target *target,
 static int dcc_count;
 static const uint8_t *dcc_buffer;
 
+/* Words queued per JTAG flush when streaming DCC data without handshake. */
+#define ARM7_9_DCC_CHUNK_WORDS	4096
+
 static int arm7_9_dcc_completion(struct target *target,
 	uint32_t exit_point,
 	int timeout_ms,
@@ -2527,7 +2530,21 @@ static int arm7_9_dcc_completion(struct target *target,
 	int little = target->endianness == TARGET_LITTLE_ENDIAN;
 	int count = dcc_count;
 	const uint8_t *buffer = dcc_buffer;
-	if (count > 2) {
+	if (arm7_9->dcc_handshake) {
+		/* The target has been seen to fall behind open loop writes, so
+		 * make sure each word has been taken before sending the next. */
+		for (int i = 0; i < count; i++) {
+			retval = embeddedice_handshake(&arm7_9->jtag_info,
+					EICE_COMM_CTRL_RBIT, 1000);
+			if (retval != ERROR_OK)
+				break;
+			embeddedice_write_reg(&arm7_9->eice_cache->reg_list[EICE_COMMS_DATA],
+				fast_target_buffer_get_u32(buffer, little));
+			buffer += 4;
+			if ((i & 0x3ff) == 0)
+				keep_alive();
+		}
+	} else if (count > 2) {
 		/* Handle first & last using standard embeddedice_write_reg and the middle ones w/the
 		 * core function repeated. */
 		embeddedice_write_reg(&arm7_9->eice_cache->reg_list[EICE_COMMS_DATA],
@@ -2540,11 +2557,24 @@ static int arm7_9_dcc_completion(struct target *target,
 		struct jtag_tap *tap;
 		tap = ice_reg->jtag_info->tap;
 
-		embeddedice_write_dcc(tap, reg_addr, buffer, little, count-2);
-		buffer += (count-2)*4;
+		/* Stream the middle words open loop, flushing the JTAG queue every
+		 * chunk so a large download does not build one huge queue. */
+		for (int left = count - 2; left > 0; ) {
+			int chunk = MIN(left, ARM7_9_DCC_CHUNK_WORDS);
+			embeddedice_write_dcc(tap, reg_addr, buffer, little, chunk);
+			buffer += chunk * 4;
+			left -= chunk;
+			if (left > 0) {
+				retval = jtag_execute_queue();
+				if (retval != ERROR_OK)
+					break;
+				keep_alive();
+			}
+		}
 
-		embeddedice_write_reg(&arm7_9->eice_cache->reg_list[EICE_COMMS_DATA],
-			fast_target_buffer_get_u32(buffer, little));
+		if (retval == ERROR_OK)
+			embeddedice_write_reg(&arm7_9->eice_cache->reg_list[EICE_COMMS_DATA],
+				fast_target_buffer_get_u32(buffer, little));
 	} else {
 		int i;
 		for (i = 0; i < count; i++) {
@@ -2554,10 +2584,12 @@ static int arm7_9_dcc_completion(struct target *target,
 		}
 	}
 
-	retval = target_halt(target);
-	if (retval != ERROR_OK)
-		return retval;
-	return target_wait_state(target, TARGET_HALTED, 500);
+	int halt_retval = target_halt(target);
+	if (halt_retval == ERROR_OK)
+		halt_retval = target_wait_state(target, TARGET_HALTED, 500);
+	if (retval == ERROR_OK)
+		retval = halt_retval;
+	return retval;
 }
 
 static const uint32_t dcc_code[] = {
@@ -2615,6 +2647,7 @@ int arm7_9_bulk_write_memory(struct target *target,
 
 	struct arm_algorithm arm_algo;
 	struct reg_param reg_params[1];
+	struct duration bench;
 
 	arm_algo.common_magic = ARM_COMMON_MAGIC;
 	arm_algo.core_mode = ARM_MODE_SVC;
@@ -2622,24 +2655,44 @@ int arm7_9_bulk_write_memory(struct target *target,
 
 	init_reg_param(&reg_params[0], "r0", 32, PARAM_IN_OUT);
 
-	buf_set_u32(reg_params[0].value, 0, 32, address);
+	for (;;) {
+		buf_set_u32(reg_params[0].value, 0, 32, address);
 
-	dcc_count = count;
-	dcc_buffer = buffer;
-	retval = armv4_5_run_algorithm_inner(target, 0, NULL, 1, reg_params,
-			arm7_9->dcc_working_area->address,
-			arm7_9->dcc_working_area->address + 6*4,
-			20*1000, &arm_algo, arm7_9_dcc_completion);
+		dcc_count = count;
+		dcc_buffer = buffer;
+		duration_start(&bench);
+		retval = armv4_5_run_algorithm_inner(target, 0, NULL, 1, reg_params,
+				arm7_9->dcc_working_area->address,
+				arm7_9->dcc_working_area->address + 6*4,
+				20*1000, &arm_algo, arm7_9_dcc_completion);
+		if (retval != ERROR_OK)
+			break;
 
-	if (retval == ERROR_OK) {
 		uint32_t endaddress = buf_get_u32(reg_params[0].value, 0, 32);
-		if (endaddress != (address + count*4)) {
+		if (endaddress == (address + count*4)) {
+			if (duration_measure(&bench) == ERROR_OK)
+				LOG_DEBUG("DCC wrote %" PRIu32 " bytes in %fs (%0.3f KiB/s%s)",
+						count * 4, duration_elapsed(&bench),
+						duration_kbps(&bench, count * 4),
+						arm7_9->dcc_handshake ? ", handshake" : "");
+			break;
+		}
+
+		if (arm7_9->dcc_handshake) {
 			LOG_ERROR(
 				"DCC write failed, expected end address 0x%08" TARGET_PRIxADDR " got 0x%0" PRIx32 "",
 				(address + count*4),
 				endaddress);
 			retval = ERROR_FAIL;
+			break;
 		}
+
+		/* Words were lost because the target could not keep up with the
+		 * open loop writes. Redo the block, and later ones, with a
+		 * handshake on every word. */
+		LOG_WARNING("DCC write lost data (end address 0x%0" PRIx32 "), "
+				"retrying with handshake", endaddress);
+		arm7_9->dcc_handshake = true;
 	}
 
 	destroy_reg_param(&reg_params[0]);
@@ -2791,8 +2844,11 @@ COMMAND_HANDLER(handle_arm7_9_dcc_downloads_command)
 		return ERROR_TARGET_INVALID;
 	}
 
-	if (CMD_ARGC > 0)
+	if (CMD_ARGC > 0) {
 		COMMAND_PARSE_ENABLE(CMD_ARGV[0], arm7_9->dcc_downloads);
+		/* give open loop writes another chance */
+		arm7_9->dcc_handshake = false;
+	}
 
 	command_print(CMD_CTX,
 		"dcc downloads are %s",
@@ -2846,6 +2902,7 @@ int arm7_9_init_arch_info(struct target *target, struct arm7_9_common *arm7_9)
 
 	arm7_9->fast_memory_access = false;
 	arm7_9->dcc_downloads = false;
+	arm7_9->dcc_handshake = false;
 
 	arm->arch_info = arm7_9;
 	arm->core_type = ARM_MODE_ANY;
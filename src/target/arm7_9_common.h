@@ -66,6 +66,7 @@ struct arm7_9_common {
 
 	bool fast_memory_access;
 	bool dcc_downloads;
+	bool dcc_handshake; /**< DCC downloads must wait for the target to take each word */
 
 	struct working_area *dcc_working_area;
 
@@ -405,6 +405,24 @@ int armv7a_cache_flush_virt(struct target *target, uint32_t virt,
 	return ERROR_OK;
 }
 
+/*
+ * Maintenance by VA costs a few debug transactions per cache line. Past the
+ * size of the L1 data cache it is cheaper to clean and invalidate the whole
+ * cache by set/way.
+ */
+static bool armv7a_cache_range_is_large(struct target *target, uint32_t size)
+{
+	struct armv7a_common *armv7a = target_to_armv7a(target);
+	struct armv7a_cache_common *armv7a_cache = &armv7a->armv7a_mmu.armv7a_cache;
+
+	uint32_t cachesize = armv7a_cache->arch[0].d_u_size.cachesize * 1024;
+
+	if (armv7a_cache->info == -1 || cachesize == 0)
+		return false;
+
+	return size > cachesize;
+}
+
 /*
  * We assume that target core was chosen correctly. It means if same data
  * was handled by two cores, other core will loose the changes. Since it
@@ -423,9 +441,39 @@ int armv7a_cache_auto_flush_on_write(struct target *target, uint32_t virt,
 	if (!armv7a->armv7a_mmu.armv7a_cache.auto_cache_enabled)
 		return ERROR_OK;
 
+	if (armv7a_cache_range_is_large(target, size))
+		return armv7a_cache_auto_flush_all_data(target);
+
 	return armv7a_cache_flush_virt(target, virt, size);
 }
 
+/*
+ * Memory read through a bus access port bypasses the core caches, so any
+ * dirty line in the range must reach memory first. Only the lines covering
+ * the range are cleaned; they stay valid in the cache.
+ */
+int armv7a_cache_auto_clean_on_read(struct target *target, uint32_t virt,
+					uint32_t size)
+{
+	struct armv7a_common *armv7a = target_to_armv7a(target);
+	struct armv7a_cache_common *armv7a_cache = &armv7a->armv7a_mmu.armv7a_cache;
+
+	if (!armv7a_cache->auto_cache_enabled || !armv7a_cache->d_u_cache_enabled)
+		return ERROR_OK;
+
+	if (armv7a_cache_range_is_large(target, size))
+		return armv7a_cache_auto_flush_all_data(target);
+
+	int retval = armv7a_l1_d_cache_clean_virt(target, virt, size);
+	if (retval != ERROR_OK)
+		return retval;
+
+	/* outer cache is optional; a missing one is not an error here */
+	armv7a_l2x_cache_clean_virt(target, virt, size);
+
+	return ERROR_OK;
+}
+
 COMMAND_HANDLER(arm7a_l1_cache_info_cmd)
 {
 	struct target *target = get_current_target(CMD_CTX);
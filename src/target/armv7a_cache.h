@@ -33,6 +33,8 @@ int armv7a_l1_i_cache_inval_virt(struct target *target, uint32_t virt,
 					uint32_t size);
 int armv7a_cache_auto_flush_on_write(struct target *target, uint32_t virt,
 					uint32_t size);
+int armv7a_cache_auto_clean_on_read(struct target *target, uint32_t virt,
+					uint32_t size);
 int armv7a_cache_auto_flush_all_data(struct target *target);
 int armv7a_cache_flush_virt(struct target *target, uint32_t virt,
 				uint32_t size);
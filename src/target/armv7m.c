@@ -735,6 +735,70 @@ cleanup:
 	return retval;
 }
 
+/** Unpacks an LZ4 block from target memory, see target_write_buffer_compressed(). */
+int armv7m_decompress_memory(struct target *target, target_addr_t src,
+		uint32_t src_size, target_addr_t dst, uint32_t dst_size)
+{
+	struct working_area *lz4_algorithm;
+	struct armv7m_algorithm armv7m_info;
+	struct reg_param reg_params[3];
+	int retval;
+
+	static const uint8_t lz4_code[] = {
+#include "../../contrib/loaders/decompress/armv7m_lz4.inc"
+	};
+
+	retval = target_alloc_working_area(target, sizeof(lz4_code), &lz4_algorithm);
+	if (retval != ERROR_OK)
+		return retval;
+
+	/* the code must not overwrite itself */
+	if (dst < lz4_algorithm->address + lz4_algorithm->size &&
+			lz4_algorithm->address < dst + dst_size) {
+		retval = ERROR_TARGET_RESOURCE_NOT_AVAILABLE;
+		goto cleanup;
+	}
+
+	retval = target_write_buffer(target, lz4_algorithm->address,
+			sizeof(lz4_code), lz4_code);
+	if (retval != ERROR_OK)
+		goto cleanup;
+
+	armv7m_info.common_magic = ARMV7M_COMMON_MAGIC;
+	armv7m_info.core_mode = ARM_MODE_THREAD;
+
+	init_reg_param(&reg_params[0], "r0", 32, PARAM_OUT);
+	init_reg_param(&reg_params[1], "r1", 32, PARAM_OUT);
+	init_reg_param(&reg_params[2], "r2", 32, PARAM_IN_OUT);
+
+	buf_set_u32(reg_params[0].value, 0, 32, src);
+	buf_set_u32(reg_params[1].value, 0, 32, src + src_size);
+	buf_set_u32(reg_params[2].value, 0, 32, dst);
+
+	int timeout = 20000 * (1 + (dst_size / (1024 * 1024)));
+
+	retval = target_run_algorithm(target, 0, NULL, 3, reg_params, lz4_algorithm->address,
+			lz4_algorithm->address + (sizeof(lz4_code) - 2),
+			timeout, &armv7m_info);
+
+	if (retval != ERROR_OK)
+		LOG_ERROR("error executing cortex_m lz4 algorithm");
+	else if (buf_get_u32(reg_params[2].value, 0, 32) != dst + dst_size) {
+		LOG_ERROR("lz4 algorithm unpacked %" PRIu32 " bytes instead of %" PRIu32,
+				(uint32_t)(buf_get_u32(reg_params[2].value, 0, 32) - dst), dst_size);
+		retval = ERROR_FAIL;
+	}
+
+	destroy_reg_param(&reg_params[0]);
+	destroy_reg_param(&reg_params[1]);
+	destroy_reg_param(&reg_params[2]);
+
+cleanup:
+	target_free_working_area(target, lz4_algorithm);
+
+	return retval;
+}
+
 /** Checks an array of memory regions whether they are erased. */
 int armv7m_blank_check_memory(struct target *target,
 	struct target_memory_check_block *blocks, int num_blocks, uint8_t erased_value)
@@ -868,6 +932,133 @@ cleanup1:
 	return retval;
 }
 
+/** Computes the checksums of an array of memory regions in a single algorithm run. */
+int armv7m_checksum_memory_blocks(struct target *target,
+	struct target_memory_check_block *blocks, int num_blocks)
+{
+	struct working_area *crc_algorithm;
+	struct working_area *crc_params;
+	struct reg_param reg_params[1];
+	struct armv7m_algorithm armv7m_info;
+	int retval;
+
+	static const uint8_t crc_blocks_code[] = {
+#include "../../contrib/loaders/checksum/armv7m_crc_blocks.inc"
+	};
+
+	const uint32_t code_size = sizeof(crc_blocks_code);
+
+	if (target_alloc_working_area(target, code_size,
+		&crc_algorithm) != ERROR_OK)
+		return ERROR_TARGET_RESOURCE_NOT_AVAILABLE;
+
+	retval = target_write_buffer(target, crc_algorithm->address,
+			code_size, crc_blocks_code);
+	if (retval != ERROR_OK)
+		goto cleanup1;
+
+	/* prepare blocks array for algo */
+	struct algo_block {
+		union {
+			uint32_t size;
+			uint32_t result;
+		};
+		uint32_t address;
+	};
+
+	uint32_t avail = target_get_working_area_avail(target);
+	int blocks_to_check = avail / sizeof(struct algo_block) - 1;
+	if (num_blocks < blocks_to_check)
+		blocks_to_check = num_blocks;
+	if (blocks_to_check < 1) {
+		retval = ERROR_TARGET_RESOURCE_NOT_AVAILABLE;
+		goto cleanup1;
+	}
+
+	struct algo_block *params = malloc((blocks_to_check + 1) * sizeof(struct algo_block));
+	if (params == NULL) {
+		retval = ERROR_FAIL;
+		goto cleanup1;
+	}
+
+	int i;
+	uint32_t total_size = 0;
+	for (i = 0; i < blocks_to_check; i++) {
+		/* a zero size would end the array early */
+		if (blocks[i].size == 0)
+			break;
+		total_size += blocks[i].size;
+		target_buffer_set_u32(target, (uint8_t *)&(params[i].size),
+						blocks[i].size);
+		target_buffer_set_u32(target, (uint8_t *)&(params[i].address),
+						blocks[i].address);
+	}
+	blocks_to_check = i;
+	if (blocks_to_check == 0) {
+		retval = 0;
+		goto cleanup2;
+	}
+	target_buffer_set_u32(target, (uint8_t *)&(params[blocks_to_check].size), 0);
+
+	uint32_t param_size = (blocks_to_check + 1) * sizeof(struct algo_block);
+	if (target_alloc_working_area(target, param_size,
+			&crc_params) != ERROR_OK) {
+		retval = ERROR_TARGET_RESOURCE_NOT_AVAILABLE;
+		goto cleanup2;
+	}
+
+	retval = target_write_buffer(target, crc_params->address,
+				param_size, (uint8_t *)params);
+	if (retval != ERROR_OK)
+		goto cleanup3;
+
+	LOG_DEBUG("Starting checksum of %d blocks, parameters@"
+		 TARGET_ADDR_FMT, blocks_to_check, crc_params->address);
+
+	armv7m_info.common_magic = ARMV7M_COMMON_MAGIC;
+	armv7m_info.core_mode = ARM_MODE_THREAD;
+
+	init_reg_param(&reg_params[0], "r0", 32, PARAM_OUT);
+	buf_set_u32(reg_params[0].value, 0, 32, crc_params->address);
+
+	int timeout = 20000 * (1 + (total_size / (1024 * 1024)));
+
+	retval = target_run_algorithm(target,
+				0, NULL,
+				ARRAY_SIZE(reg_params), reg_params,
+				crc_algorithm->address,
+				crc_algorithm->address + (code_size - 2),
+				timeout,
+				&armv7m_info);
+	if (retval != ERROR_OK) {
+		LOG_ERROR("error executing cortex_m crc blocks algorithm");
+		goto cleanup4;
+	}
+
+	retval = target_read_buffer(target, crc_params->address,
+				param_size, (uint8_t *)params);
+	if (retval != ERROR_OK)
+		goto cleanup4;
+
+	for (i = 0; i < blocks_to_check; i++)
+		blocks[i].result = target_buffer_get_u32(target,
+					(uint8_t *)&(params[i].result));
+
+	retval = blocks_to_check;	/* return number of blocks really checked */
+
+cleanup4:
+	destroy_reg_param(&reg_params[0]);
+
+cleanup3:
+	target_free_working_area(target, crc_params);
+cleanup2:
+	free(params);
+cleanup1:
+	target_free_working_area(target, crc_algorithm);
+
+	return retval;
+}
+
 int armv7m_maybe_skip_bkpt_inst(struct target *target, bool *inst_found)
 {
 	struct armv7m_common *armv7m = target_to_armv7m(target);
@@ -24,32 +24,521 @@
 #include <target/cortex_m.h>
 #include <target/armv7m_trace.h>
 #include <jtag/interface.h>
+#include <helper/time_support.h>
+#include <fcntl.h>
 
-#define TRACE_BUF_SIZE	4096
+/* Captured trace data is staged in a ring between the adapter and the
+ * consumers. Polling runs from the main loop timer, so while a long command
+ * keeps the main loop busy the probe has to buffer on its own; as soon as
+ * polling resumes the whole backlog is pulled out of the probe, and handed
+ * on to the consumers over the following polls. */
+#define TRACE_RING_SIZE		(1024 * 1024)
+#define TRACE_CONSUME_BUDGET	(256 * 1024)
+
+#define ITM_STIMULUS_PORTS	256
+#define ITM_EXCEPTIONS		512
+#define ITM_PC_HIST_SIZE	1024
+#define ITM_PENDING_EVENTS	16
+
+/* DWT hardware source discriminators */
+#define DWT_DISC_EVENT_COUNTER	0
+#define DWT_DISC_EXCEPTION	1
+#define DWT_DISC_PC_SAMPLE	2
+
+struct itm_exception_stats {
+	uint32_t entries;
+	uint32_t timed;		/* entries with a measured duration */
+	uint64_t total_ticks;
+	uint32_t max_ticks;
+	uint64_t entered_at;
+	bool entered;		/* entry time known, waiting for the exit */
+};
+
+struct itm_pc_sample {
+	uint32_t pc;
+	uint32_t count;		/* 0 marks a free slot */
+};
+
+/* Exception event waiting for the local timestamp that follows it. */
+struct itm_pending_event {
+	uint16_t exception;
+	uint8_t function;
+};
+
+enum itm_decode_state {
+	ITM_STATE_HEADER,
+	ITM_STATE_SOURCE,	/* fixed size source packet payload */
+	ITM_STATE_CONTINUATION,	/* payload bytes with a continuation bit */
+};
+
+struct armv7m_trace_decoder {
+	/* TPIU formatter */
+	uint8_t frame[16];
+	unsigned int frame_len;
+	uint32_t sync_shift;
+	bool frame_synced;
+	unsigned int frame_id;
+
+	/* ITM/DWT packet parser */
+	enum itm_decode_state state;
+	uint8_t header;
+	uint8_t payload[5];
+	unsigned int payload_len;
+	unsigned int payload_size;
+	unsigned int zero_run;
+	unsigned int stimulus_page;
+
+	/* time in timestamp counter ticks, from local timestamps */
+	uint64_t now;
+	struct itm_pending_event pending[ITM_PENDING_EVENTS];
+	unsigned int num_pending;
+
+	/* statistics */
+	uint64_t bytes;
+	uint64_t packets;
+	uint64_t frames;
+	uint64_t other_id_bytes;
+	uint32_t syncs;
+	uint32_t overflows;
+	uint32_t errors;
+	uint64_t port_bytes[ITM_STIMULUS_PORTS];
+	uint64_t port_dropped[ITM_STIMULUS_PORTS];
+	uint64_t event_counter_packets;
+	struct itm_exception_stats exceptions[ITM_EXCEPTIONS];
+	struct itm_pc_sample pc_hist[ITM_PC_HIST_SIZE];
+	unsigned int pc_hist_used;
+	uint64_t pc_samples;
+	uint64_t pc_sleep_samples;
+	uint64_t pc_samples_lost;
+
+	/* per stimulus port outputs */
+	FILE *port_sink[ITM_STIMULUS_PORTS];
+
+	/* capture ring; head and tail count bytes since the start */
+	uint8_t *ring;
+	uint64_t ring_head;
+	uint64_t ring_tail;
+	uint64_t captured;
+	uint64_t ring_peak;
+	uint32_t ring_full;
+	int64_t last_poll_ms;
+	int64_t max_poll_gap_ms;
+};
+
+static struct armv7m_trace_decoder *armv7m_trace_get_decoder(struct armv7m_common *armv7m)
+{
+	if (!armv7m->trace_config.decoder)
+		armv7m->trace_config.decoder = calloc(1, sizeof(struct armv7m_trace_decoder));
+	return armv7m->trace_config.decoder;
+}
+
+static void itm_reset_stats(struct armv7m_trace_decoder *dec)
+{
+	dec->bytes = 0;
+	dec->packets = 0;
+	dec->frames = 0;
+	dec->other_id_bytes = 0;
+	dec->syncs = 0;
+	dec->overflows = 0;
+	dec->errors = 0;
+	memset(dec->port_bytes, 0, sizeof(dec->port_bytes));
+	memset(dec->port_dropped, 0, sizeof(dec->port_dropped));
+	dec->event_counter_packets = 0;
+	memset(dec->exceptions, 0, sizeof(dec->exceptions));
+	memset(dec->pc_hist, 0, sizeof(dec->pc_hist));
+	dec->pc_hist_used = 0;
+	dec->pc_samples = 0;
+	dec->pc_sleep_samples = 0;
+	dec->pc_samples_lost = 0;
+	dec->num_pending = 0;
+	dec->captured = 0;
+	dec->ring_peak = dec->ring_head - dec->ring_tail;
+	dec->ring_full = 0;
+	dec->max_poll_gap_ms = 0;
+}
+
+static void itm_exception_event(struct armv7m_trace_decoder *dec,
+		unsigned int exception, unsigned int function, bool timed)
+{
+	struct itm_exception_stats *exc = &dec->exceptions[exception % ITM_EXCEPTIONS];
+
+	switch (function) {
+	case 1:	/* entered */
+		exc->entries++;
+		exc->entered = timed;
+		exc->entered_at = dec->now;
+		break;
+	case 2:	/* exited */
+		if (exc->entered && timed) {
+			uint64_t ticks = dec->now - exc->entered_at;
+			exc->timed++;
+			exc->total_ticks += ticks;
+			if (ticks > exc->max_ticks)
+				exc->max_ticks = ticks > UINT32_MAX ? UINT32_MAX : ticks;
+		}
+		exc->entered = false;
+		break;
+	default: /* returned to, or reserved */
+		break;
+	}
+}
+
+static void itm_flush_pending(struct armv7m_trace_decoder *dec, bool timed)
+{
+	for (unsigned int i = 0; i < dec->num_pending; i++)
+		itm_exception_event(dec, dec->pending[i].exception,
+				dec->pending[i].function, timed);
+	dec->num_pending = 0;
+}
+
+static void itm_pc_sample(struct armv7m_trace_decoder *dec, uint32_t pc)
+{
+	dec->pc_samples++;
+
+	unsigned int slot = ((pc >> 1) * 2654435761u) % ITM_PC_HIST_SIZE;
+	for (unsigned int i = 0; i < ITM_PC_HIST_SIZE; i++) {
+		struct itm_pc_sample *entry = &dec->pc_hist[slot];
+		if (entry->count == 0) {
+			entry->pc = pc;
+			entry->count = 1;
+			dec->pc_hist_used++;
+			return;
+		}
+		if (entry->pc == pc) {
+			entry->count++;
+			return;
+		}
+		/* the table is full, don't probe all of it for every sample */
+		if (dec->pc_hist_used == ITM_PC_HIST_SIZE)
+			break;
+		slot = (slot + 1) % ITM_PC_HIST_SIZE;
+	}
+	dec->pc_samples_lost++;
+}
+
+static void itm_source_packet(struct armv7m_common *armv7m,
+		struct armv7m_trace_decoder *dec)
+{
+	unsigned int id = dec->header >> 3;
+	uint32_t value = 0;
+
+	for (unsigned int i = 0; i < dec->payload_len; i++)
+		value |= dec->payload[i] << (8 * i);
+
+	if (!(dec->header & 0x04)) {
+		/* software source, i.e. ITM stimulus port */
+		unsigned int port = dec->stimulus_page * 32 + id;
+		dec->port_bytes[port] += dec->payload_len;
+		FILE *sink = dec->port_sink[port];
+		if (!sink)
+			return;
+		size_t written = fwrite(dec->payload, 1, dec->payload_len, sink);
+		if (written == dec->payload_len)
+			return;
+		if (errno == EAGAIN || errno == EWOULDBLOCK) {
+			/* the reader of a pipe doesn't keep up, drop rather than
+			 * stall the event loop */
+			dec->port_dropped[port] += dec->payload_len - written;
+			clearerr(sink);
+		} else {
+			LOG_ERROR("Error writing to the sink of ITM port %u, closing it", port);
+			fclose(sink);
+			dec->port_sink[port] = NULL;
+		}
+		return;
+	}
+
+	switch (id) {
+	case DWT_DISC_EVENT_COUNTER:
+		dec->event_counter_packets++;
+		break;
+	case DWT_DISC_EXCEPTION:
+		if (dec->payload_len != 2) {
+			dec->errors++;
+			break;
+		}
+		if (!armv7m->trace_config.itm_diff_timestamps) {
+			itm_exception_event(dec, value & 0x1ff, (value >> 12) & 3, false);
+			break;
+		}
+		/* local timestamps apply to the packets in front of them */
+		if (dec->num_pending == ITM_PENDING_EVENTS)
+			itm_flush_pending(dec, false);
+		dec->pending[dec->num_pending].exception = value & 0x1ff;
+		dec->pending[dec->num_pending].function = (value >> 12) & 3;
+		dec->num_pending++;
+		break;
+	case DWT_DISC_PC_SAMPLE:
+		if (dec->payload_len == 4)
+			itm_pc_sample(dec, value);
+		else
+			dec->pc_sleep_samples++;
+		break;
+	default:
+		/* data trace packets are counted but not decoded further */
+		break;
+	}
+}
+
+static void itm_continuation_packet(struct armv7m_trace_decoder *dec)
+{
+	uint32_t value = 0;
+
+	for (unsigned int i = 0; i < dec->payload_len && i < 5; i++)
+		value |= (uint32_t)(dec->payload[i] & 0x7f) << (7 * i);
+
+	if ((dec->header & 0x0f) == 0x00) {
+		/* local timestamp, format 1 */
+		dec->now += value;
+		itm_flush_pending(dec, true);
+	} else if ((dec->header & 0x0b) == 0x08) {
+		/* extension; a stimulus port page when it has no payload */
+		if (!(dec->header & 0x04) && dec->payload_len == 0)
+			dec->stimulus_page = (dec->header >> 4) & 7;
+	}
+	/* global timestamps carry no information used here */
+}
+
+static void itm_decode_byte(struct armv7m_common *armv7m,
+		struct armv7m_trace_decoder *dec, uint8_t b)
+{
+	switch (dec->state) {
+	case ITM_STATE_SOURCE:
+		dec->payload[dec->payload_len++] = b;
+		if (dec->payload_len == dec->payload_size) {
+			itm_source_packet(armv7m, dec);
+			dec->state = ITM_STATE_HEADER;
+		}
+		return;
+	case ITM_STATE_CONTINUATION:
+		if (dec->payload_len < ARRAY_SIZE(dec->payload))
+			dec->payload[dec->payload_len++] = b;
+		else
+			dec->errors++;
+		if (!(b & 0x80)) {
+			itm_continuation_packet(dec);
+			dec->state = ITM_STATE_HEADER;
+		}
+		return;
+	case ITM_STATE_HEADER:
+		break;
+	}
+
+	/* synchronization: at least 47 zero bits followed by a one */
+	if (b == 0x00) {
+		dec->zero_run++;
+		return;
+	}
+	if (b == 0x80 && dec->zero_run >= 5) {
+		dec->zero_run = 0;
+		dec->syncs++;
+		return;
+	}
+	dec->zero_run = 0;
+
+	dec->packets++;
+	dec->header = b;
+	dec->payload_len = 0;
+
+	if (b == 0x70) {
+		dec->overflows++;
+		/* the timing of anything still waiting is unknown now */
+		itm_flush_pending(dec, false);
+	} else if (b & 0x03) {
+		dec->payload_size = 1 << ((b & 0x03) - 1);
+		dec->state = ITM_STATE_SOURCE;
+	} else if (b == 0x94 || b == 0xb4) {
+		/* global timestamp */
+		dec->state = ITM_STATE_CONTINUATION;
+	} else if ((b & 0x0f) == 0x00) {
+		if (!(b & 0x80)) {
+			/* local timestamp, format 2 */
+			dec->now += (b >> 4) & 7;
+			itm_flush_pending(dec, true);
+		} else if ((b & 0xc0) == 0xc0) {
+			dec->state = ITM_STATE_CONTINUATION;
+		} else {
+			dec->errors++;
+		}
+	} else if ((b & 0x0b) == 0x08) {
+		if (b & 0x80)
+			dec->state = ITM_STATE_CONTINUATION;
+		else
+			itm_continuation_packet(dec);
+	} else {
+		dec->errors++;
+	}
+}
+
+static void tpiu_emit_byte(struct armv7m_common *armv7m,
+		struct armv7m_trace_decoder *dec, unsigned int id, uint8_t b)
+{
+	if (id == armv7m->trace_config.trace_bus_id)
+		itm_decode_byte(armv7m, dec, b);
+	else if (id != 0x00 && id != 0x7f)
+		dec->other_id_bytes++;
+}
+
+/* Unpack one 16 byte TPIU formatter frame. Even bytes carry either data
+ * (with the LSB stored in the last byte) or a source ID change; for an ID
+ * change the auxiliary bit tells whether it applies before or after the odd
+ * byte that follows. */
+static void tpiu_decode_frame(struct armv7m_common *armv7m,
+		struct armv7m_trace_decoder *dec)
+{
+	const uint8_t *frame = dec->frame;
+	uint8_t aux = frame[15];
+
+	dec->frames++;
+
+	for (unsigned int i = 0; i < 8; i++) {
+		uint8_t b = frame[2 * i];
+		bool aux_bit = (aux >> i) & 1;
+
+		if (b & 1) {
+			unsigned int new_id = b >> 1;
+			if (i < 7 && aux_bit) {
+				tpiu_emit_byte(armv7m, dec, dec->frame_id, frame[2 * i + 1]);
+				dec->frame_id = new_id;
+			} else {
+				dec->frame_id = new_id;
+				if (i < 7)
+					tpiu_emit_byte(armv7m, dec, dec->frame_id, frame[2 * i + 1]);
+			}
+		} else {
+			tpiu_emit_byte(armv7m, dec, dec->frame_id, (b & 0xfe) | aux_bit);
+			if (i < 7)
+				tpiu_emit_byte(armv7m, dec, dec->frame_id, frame[2 * i + 1]);
+		}
+	}
+}
+
+static void armv7m_trace_decode(struct armv7m_common *armv7m,
+		const uint8_t *buf, size_t size)
+{
+	struct armv7m_trace_decoder *dec = armv7m_trace_get_decoder(armv7m);
+	if (!dec)
+		return;
+
+	dec->bytes += size;
+
+	/* The formatter is always on for the synchronous port. */
+	if (armv7m->trace_config.pin_protocol != TPIU_PIN_PROTOCOL_SYNC &&
+			!armv7m->trace_config.formatter) {
+		for (size_t i = 0; i < size; i++)
+			itm_decode_byte(armv7m, dec, buf[i]);
+		return;
+	}
+
+	for (size_t i = 0; i < size; i++) {
+		/* a full sync packet realigns the frames */
+		dec->sync_shift = (dec->sync_shift << 8) | buf[i];
+		if (dec->sync_shift == 0xffffff7f) {
+			dec->frame_synced = true;
+			dec->frame_len = 0;
+			continue;
+		}
+		if (!dec->frame_synced)
+			continue;
+
+		dec->frame[dec->frame_len++] = buf[i];
+		if (dec->frame_len == sizeof(dec->frame)) {
+			tpiu_decode_frame(armv7m, dec);
+			dec->frame_len = 0;
+		}
+	}
+}
+
+static void armv7m_trace_flush_sinks(struct armv7m_common *armv7m)
+{
+	struct armv7m_trace_decoder *dec = armv7m->trace_config.decoder;
+	if (!dec)
+		return;
+
+	for (unsigned int port = 0; port < ITM_STIMULUS_PORTS; port++)
+		if (dec->port_sink[port])
+			fflush(dec->port_sink[port]);
+}
 
 static int armv7m_poll_trace(void *target)
 {
 	struct armv7m_common *armv7m = target_to_armv7m(target);
-	uint8_t buf[TRACE_BUF_SIZE];
-	size_t size = sizeof(buf);
-	int retval;
+	struct armv7m_trace_decoder *dec = armv7m_trace_get_decoder(armv7m);
+	int retval = ERROR_OK;
 
-	retval = adapter_poll_trace(buf, &size);
-	if (retval != ERROR_OK || !size)
-		return retval;
-
-	target_call_trace_callbacks(target, size, buf);
+	if (!dec)
+		return ERROR_FAIL;
 
-	if (armv7m->trace_config.trace_file != NULL) {
-		if (fwrite(buf, 1, size, armv7m->trace_config.trace_file) == size)
-			fflush(armv7m->trace_config.trace_file);
-		else {
-			LOG_ERROR("Error writing to the trace destination file");
+	if (!dec->ring) {
+		dec->ring = malloc(TRACE_RING_SIZE);
+		if (!dec->ring) {
+			LOG_ERROR("Out of memory");
 			return ERROR_FAIL;
 		}
+		dec->ring_head = dec->ring_tail = 0;
 	}
 
-	return ERROR_OK;
+	int64_t now = timeval_ms();
+	if (dec->last_poll_ms && now - dec->last_poll_ms > dec->max_poll_gap_ms)
+		dec->max_poll_gap_ms = now - dec->last_poll_ms;
+	dec->last_poll_ms = now;
+
+	/* Capture: read everything the adapter has straight into the ring, so
+	 * the probe FIFO is emptied even when the consumers fall behind. */
+	for (;;) {
+		uint64_t used = dec->ring_head - dec->ring_tail;
+		if (used == TRACE_RING_SIZE) {
+			/* leave the rest in the probe */
+			dec->ring_full++;
+			break;
+		}
+
+		size_t offset = dec->ring_head % TRACE_RING_SIZE;
+		size_t space = MIN(TRACE_RING_SIZE - used, TRACE_RING_SIZE - offset);
+		size_t size = space;
+
+		retval = adapter_poll_trace(dec->ring + offset, &size);
+		if (retval != ERROR_OK)
+			break;
+
+		dec->ring_head += size;
+		dec->captured += size;
+		if (dec->ring_head - dec->ring_tail > dec->ring_peak)
+			dec->ring_peak = dec->ring_head - dec->ring_tail;
+
+		if (size < space)
+			break;
+	}
+
+	/* Consume: hand at most TRACE_CONSUME_BUDGET bytes per poll to the
+	 * callbacks, the decoder and the trace file, in contiguous pieces. */
+	size_t budget = TRACE_CONSUME_BUDGET;
+	while (budget && dec->ring_head != dec->ring_tail) {
+		size_t offset = dec->ring_tail % TRACE_RING_SIZE;
+		size_t size = MIN(dec->ring_head - dec->ring_tail, TRACE_RING_SIZE - offset);
+		size = MIN(size, budget);
+		uint8_t *buf = dec->ring + offset;
+
+		dec->ring_tail += size;
+		budget -= size;
+
+		target_call_trace_callbacks(target, size, buf);
+
+		armv7m_trace_decode(armv7m, buf, size);
+
+		if (armv7m->trace_config.trace_file != NULL) {
+			if (fwrite(buf, 1, size, armv7m->trace_config.trace_file) != size) {
+				LOG_ERROR("Error writing to the trace destination file");
+				return ERROR_FAIL;
+			}
+		}
+	}
+
+	if (armv7m->trace_config.trace_file != NULL)
+		fflush(armv7m->trace_config.trace_file);
+	armv7m_trace_flush_sinks(armv7m);
+
+	return retval;
 }
 
 int armv7m_trace_tpiu_config(struct target *target)
@@ -61,6 +550,20 @@ int armv7m_trace_tpiu_config(struct target *target)
 
 	target_unregister_timer_callback(armv7m_poll_trace, target);
 
+	/* the stream restarts; wait for sync before decoding again */
+	if (trace_config->decoder) {
+		struct armv7m_trace_decoder *dec = trace_config->decoder;
+		dec->frame_synced = false;
+		dec->frame_len = 0;
+		dec->sync_shift = 0;
+		dec->frame_id = 0;
+		dec->state = ITM_STATE_HEADER;
+		dec->zero_run = 0;
+		dec->stimulus_page = 0;
+		dec->num_pending = 0;
+		dec->ring_tail = dec->ring_head;
+		dec->last_poll_ms = 0;
+	}
 
 	retval = adapter_config_trace(trace_config->config_type == TRACE_CONFIG_TYPE_INTERNAL,
 				      trace_config->pin_protocol,
@@ -160,6 +663,25 @@ static void close_trace_file(struct armv7m_common *armv7m)
 	armv7m->trace_config.trace_file = NULL;
 }
 
+void armv7m_trace_free(struct target *target)
+{
+	struct armv7m_common *armv7m = target_to_armv7m(target);
+	struct armv7m_trace_decoder *dec = armv7m->trace_config.decoder;
+
+	target_unregister_timer_callback(armv7m_poll_trace, target);
+	close_trace_file(armv7m);
+
+	if (!dec)
+		return;
+
+	for (unsigned int port = 0; port < ITM_STIMULUS_PORTS; port++)
+		if (dec->port_sink[port])
+			fclose(dec->port_sink[port]);
+	free(dec->ring);
+	free(dec);
+	armv7m->trace_config.decoder = NULL;
+}
+
 COMMAND_HANDLER(handle_tpiu_config_command)
 {
 	struct target *target = get_current_target(CMD_CTX);
@@ -300,6 +822,158 @@ COMMAND_HANDLER(handle_itm_ports_command)
 		return ERROR_OK;
 }
 
+/* A sink may be a named pipe, which must not block the event loop when
+ * its reader is slow. Writes are unbuffered, so that a short write tells
+ * exactly how much was dropped. */
+static FILE *itm_open_sink(const char *path)
+{
+#ifdef _WIN32
+	return fopen(path, "ab");
+#else
+	int fd = open(path, O_WRONLY | O_CREAT | O_APPEND | O_NONBLOCK, 0644);
+	if (fd == -1)
+		return NULL;
+
+	FILE *sink = fdopen(fd, "ab");
+	if (!sink) {
+		close(fd);
+		return NULL;
+	}
+	setvbuf(sink, NULL, _IONBF, 0);
+	return sink;
+#endif
+}
+
+COMMAND_HANDLER(handle_itm_sink_command)
+{
+	struct target *target = get_current_target(CMD_CTX);
+	struct armv7m_common *armv7m = target_to_armv7m(target);
+	struct armv7m_trace_decoder *dec;
+	unsigned int port;
+
+	if (CMD_ARGC != 2)
+		return ERROR_COMMAND_SYNTAX_ERROR;
+
+	COMMAND_PARSE_NUMBER(uint, CMD_ARGV[0], port);
+	if (port >= ITM_STIMULUS_PORTS)
+		return ERROR_COMMAND_SYNTAX_ERROR;
+
+	dec = armv7m_trace_get_decoder(armv7m);
+	if (!dec) {
+		LOG_ERROR("Out of memory");
+		return ERROR_FAIL;
+	}
+
+	if (dec->port_sink[port]) {
+		fclose(dec->port_sink[port]);
+		dec->port_sink[port] = NULL;
+	}
+
+	if (strcmp(CMD_ARGV[1], "none") != 0) {
+		dec->port_sink[port] = itm_open_sink(CMD_ARGV[1]);
+		if (!dec->port_sink[port]) {
+			if (errno == ENXIO)
+				LOG_ERROR("Can't open sink for ITM port %u: "
+						"no process reads the pipe", port);
+			else
+				LOG_ERROR("Can't open sink for ITM port %u", port);
+			return ERROR_FAIL;
+		}
+	}
+
+	return ERROR_OK;
+}
+
+static int itm_pc_sample_compare(const void *a, const void *b)
+{
+	const struct itm_pc_sample *sa = a, *sb = b;
+
+	if (sa->count != sb->count)
+		return sa->count < sb->count ? 1 : -1;
+	return sa->pc < sb->pc ? -1 : sa->pc > sb->pc;
+}
+
+COMMAND_HANDLER(handle_itm_stats_command)
+{
+	struct target *target = get_current_target(CMD_CTX);
+	struct armv7m_common *armv7m = target_to_armv7m(target);
+	struct armv7m_trace_decoder *dec;
+	unsigned int top = 16;
+
+	if (CMD_ARGC > 1)
+		return ERROR_COMMAND_SYNTAX_ERROR;
+
+	dec = armv7m_trace_get_decoder(armv7m);
+	if (!dec) {
+		LOG_ERROR("Out of memory");
+		return ERROR_FAIL;
+	}
+
+	if (CMD_ARGC == 1) {
+		if (!strcmp(CMD_ARGV[0], "reset")) {
+			itm_reset_stats(dec);
+			return ERROR_OK;
+		}
+		COMMAND_PARSE_NUMBER(uint, CMD_ARGV[0], top);
+	}
+
+	command_print(CMD_CTX, "captured %" PRIu64 " bytes, %" PRIu64 " buffered (peak %" PRIu64
+			" of %u), ring full %" PRIu32 " times, longest poll gap %" PRId64 " ms",
+			dec->captured, dec->ring_head - dec->ring_tail, dec->ring_peak,
+			TRACE_RING_SIZE, dec->ring_full, dec->max_poll_gap_ms);
+	command_print(CMD_CTX, "trace bytes %" PRIu64 ", TPIU frames %" PRIu64
+			", bytes of other sources %" PRIu64,
+			dec->bytes, dec->frames, dec->other_id_bytes);
+	command_print(CMD_CTX, "packets %" PRIu64 ", syncs %" PRIu32
+			", overflows %" PRIu32 ", errors %" PRIu32,
+			dec->packets, dec->syncs, dec->overflows, dec->errors);
+
+	for (unsigned int port = 0; port < ITM_STIMULUS_PORTS; port++)
+		if (dec->port_bytes[port])
+			command_print(CMD_CTX, "stimulus port %u: %" PRIu64 " bytes, "
+					"%" PRIu64 " dropped by the sink",
+					port, dec->port_bytes[port], dec->port_dropped[port]);
+
+	if (dec->event_counter_packets)
+		command_print(CMD_CTX, "event counter packets %" PRIu64,
+				dec->event_counter_packets);
+
+	for (unsigned int i = 0; i < ITM_EXCEPTIONS; i++) {
+		struct itm_exception_stats *exc = &dec->exceptions[i];
+		if (!exc->entries)
+			continue;
+		if (exc->timed)
+			command_print(CMD_CTX, "exception %u: %" PRIu32 " entries, "
+					"ticks avg %" PRIu64 " max %" PRIu32,
+					i, exc->entries, exc->total_ticks / exc->timed,
+					exc->max_ticks);
+		else
+			command_print(CMD_CTX, "exception %u: %" PRIu32 " entries",
+					i, exc->entries);
+	}
+
+	if (dec->pc_samples || dec->pc_sleep_samples) {
+		command_print(CMD_CTX, "PC samples %" PRIu64 ", sleeping %" PRIu64
+				", not in histogram %" PRIu64,
+				dec->pc_samples, dec->pc_sleep_samples, dec->pc_samples_lost);
+
+		struct itm_pc_sample *sorted = malloc(sizeof(dec->pc_hist));
+		if (!sorted) {
+			LOG_ERROR("Out of memory");
+			return ERROR_FAIL;
+		}
+		memcpy(sorted, dec->pc_hist, sizeof(dec->pc_hist));
+		qsort(sorted, ITM_PC_HIST_SIZE, sizeof(*sorted), itm_pc_sample_compare);
+		for (unsigned int i = 0; i < top && i < ITM_PC_HIST_SIZE && sorted[i].count; i++)
+			command_print(CMD_CTX, "  0x%08" PRIx32 " %" PRIu32 " (%.1f%%)",
+					sorted[i].pc, sorted[i].count,
+					100.0 * sorted[i].count / dec->pc_samples);
+		free(sorted);
+	}
+
+	return ERROR_OK;
+}
+
 static const struct command_registration tpiu_command_handlers[] = {
 	{
 		.name = "config",
@@ -329,6 +1003,20 @@ static const struct command_registration itm_command_handlers[] = {
 		.help = "Enable or disable all ITM stimulus ports",
 		.usage = "(0|1|on|off)",
 	},
+	{
+		.name = "sink",
+		.handler = handle_itm_sink_command,
+		.mode = COMMAND_ANY,
+		.help = "Append the data of an ITM stimulus port to a file (or FIFO)",
+		.usage = "<port> (<filename>|none)",
+	},
+	{
+		.name = "stats",
+		.handler = handle_itm_stats_command,
+		.mode = COMMAND_EXEC,
+		.help = "Show or reset statistics of the decoded trace stream",
+		.usage = "[reset|<number of top PC samples>]",
+	},
 	COMMAND_REGISTRATION_DONE
 };
 
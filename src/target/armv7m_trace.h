@@ -75,6 +75,8 @@ struct armv7m_trace_config {
 	unsigned int trace_freq;
 	/** Handle to output trace data in INTERNAL capture mode */
 	FILE *trace_file;
+	/** Decoder for trace data captured in INTERNAL mode, allocated on demand */
+	struct armv7m_trace_decoder *decoder;
 };
 
 extern const struct command_registration armv7m_trace_command_handlers[];
@@ -87,5 +89,9 @@ int armv7m_trace_tpiu_config(struct target *target);
  * Configure hardware accordingly to the current ITM target settings
  */
 int armv7m_trace_itm_config(struct target *target);
+/**
+ * Release the trace decoder, its output sinks and the trace file
+ */
+void armv7m_trace_free(struct target *target);
 
 #endif /* OPENOCD_TARGET_ARMV7M_TRACE_H */
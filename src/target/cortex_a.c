@@ -80,7 +80,8 @@ static int cortex_a_mmu_modify(struct target *target, int enable);
 static int cortex_a_virt2phys(struct target *target,
 	target_addr_t virt, target_addr_t *phys);
 static int cortex_a_read_cpu_memory(struct target *target,
-	uint32_t address, uint32_t size, uint32_t count, uint8_t *buffer);
+	uint32_t address, uint32_t size, uint32_t count, uint8_t *buffer,
+	bool as_buffer);
 
 
 /*  restore cp15_control_reg at resume */
@@ -2253,11 +2254,75 @@ static int cortex_a_write_cpu_memory_fast(struct target *target,
 			4, count, armv7a->debug_base + CPUDBG_DTRRX);
 }
 
+static int cortex_a_write_cpu_memory_buffer(struct target *target,
+	uint32_t address, uint32_t count, const uint8_t *buffer, uint32_t *dscr)
+{
+	/* Writes count bytes from *buffer, using the same access sizes as
+	 * target_write_buffer() would: narrow stores up to the first word
+	 * boundary, fast mode for the aligned middle and narrow stores for the
+	 * tail. Doing it all in one call saves the DCC, DFAR and DFSR setup for
+	 * each piece. Old value of DSCR must be in *dscr; updated to new value.
+	 * Preconditions:
+	 * - Address is in R0.
+	 * - R0 is marked dirty.
+	 */
+	uint32_t size;
+	int retval;
+
+	/* Store the unaligned head. */
+	for (size = 1; size < 4 && count >= size * 2 + (address & size); size *= 2) {
+		if (address & size) {
+			retval = cortex_a_write_cpu_memory_slow(target, size, 1, buffer, dscr);
+			if (retval != ERROR_OK)
+				return retval;
+			if (*dscr & (DSCR_STICKY_ABORT_PRECISE | DSCR_STICKY_ABORT_IMPRECISE))
+				return ERROR_OK;
+			address += size;
+			count -= size;
+			buffer += size;
+		}
+	}
+
+	/* Store the rest with as large access size as possible. */
+	for (; size > 0; size /= 2) {
+		uint32_t aligned = count - count % size;
+		if (aligned == 0)
+			continue;
+
+		if (size == 4) {
+			retval = cortex_a_write_cpu_memory_fast(target, aligned / 4, buffer, dscr);
+			if (retval == ERROR_OK && aligned < count) {
+				/* The tail goes through the slow path, which expects the last
+				 * STC to have retired and DTRRX to be empty. */
+				retval = cortex_a_set_dcc_mode(target, DSCR_EXT_DCC_NON_BLOCKING, dscr);
+				if (retval == ERROR_OK)
+					retval = cortex_a_wait_instrcmpl(target, dscr, true);
+				if (retval == ERROR_OK && !(*dscr & DSCR_STICKY_ABORT_PRECISE))
+					retval = cortex_a_wait_dscr_bits(target,
+							DSCR_DTRRX_FULL_LATCHED, 0, dscr);
+			}
+		} else {
+			retval = cortex_a_write_cpu_memory_slow(target, size, aligned / size,
+					buffer, dscr);
+		}
+		if (retval != ERROR_OK)
+			return retval;
+		if (*dscr & (DSCR_STICKY_ABORT_PRECISE | DSCR_STICKY_ABORT_IMPRECISE))
+			return ERROR_OK;
+
+		count -= aligned;
+		buffer += aligned;
+	}
+
+	return ERROR_OK;
+}
+
 static int cortex_a_write_cpu_memory(struct target *target,
 	uint32_t address, uint32_t size,
-	uint32_t count, const uint8_t *buffer)
+	uint32_t count, const uint8_t *buffer, bool as_buffer)
 {
-	/* Write memory through the CPU. */
+	/* Write memory through the CPU. With as_buffer set, size must be 1 and
+	 * the access size is chosen per piece as for target_write_buffer(). */
 	int retval, final_retval;
 	struct armv7a_common *armv7a = target_to_armv7a(target);
 	struct arm *arm = &armv7a->arm;
@@ -2307,7 +2372,10 @@ static int cortex_a_write_cpu_memory(struct target *target,
 	if (retval != ERROR_OK)
 		goto out;
 
-	if (size == 4 && (address % 4) == 0) {
+	if (as_buffer) {
+		/* Byte buffer, split into aligned pieces in this session. */
+		retval = cortex_a_write_cpu_memory_buffer(target, address, count, buffer, &dscr);
+	} else if (size == 4 && (address % 4) == 0) {
 		/* We are doing a word-aligned transfer, so use fast mode. */
 		retval = cortex_a_write_cpu_memory_fast(target, count, buffer, &dscr);
 	} else {
@@ -2555,11 +2623,65 @@ static int cortex_a_read_cpu_memory_fast(struct target *target,
 	return ERROR_OK;
 }
 
+static int cortex_a_read_cpu_memory_buffer(struct target *target,
+	uint32_t address, uint32_t count, uint8_t *buffer, uint32_t *dscr)
+{
+	/* Reads count bytes into *buffer, using the same access sizes as
+	 * target_read_buffer() would: narrow loads up to the first word boundary,
+	 * fast mode for the aligned middle and narrow loads for the tail. Old
+	 * value of DSCR must be in *dscr; updated to new value.
+	 * Preconditions:
+	 * - Address is in R0.
+	 * - R0 is marked dirty.
+	 */
+	uint32_t size;
+	int retval;
+
+	/* Load the unaligned head. */
+	for (size = 1; size < 4 && count >= size * 2 + (address & size); size *= 2) {
+		if (address & size) {
+			retval = cortex_a_read_cpu_memory_slow(target, size, 1, buffer, dscr);
+			if (retval != ERROR_OK)
+				return retval;
+			if (*dscr & (DSCR_STICKY_ABORT_PRECISE | DSCR_STICKY_ABORT_IMPRECISE))
+				return ERROR_OK;
+			address += size;
+			count -= size;
+			buffer += size;
+		}
+	}
+
+	/* Load the rest with as large access size as possible. The fast path
+	 * leaves the DCC in non-blocking mode with the last LDC retired, so the
+	 * slow path can carry on from the incremented R0. */
+	for (; size > 0; size /= 2) {
+		uint32_t aligned = count - count % size;
+		if (aligned == 0)
+			continue;
+
+		if (size == 4)
+			retval = cortex_a_read_cpu_memory_fast(target, aligned / 4, buffer, dscr);
+		else
+			retval = cortex_a_read_cpu_memory_slow(target, size, aligned / size,
+					buffer, dscr);
+		if (retval != ERROR_OK)
+			return retval;
+		if (*dscr & (DSCR_STICKY_ABORT_PRECISE | DSCR_STICKY_ABORT_IMPRECISE))
+			return ERROR_OK;
+
+		count -= aligned;
+		buffer += aligned;
+	}
+
+	return ERROR_OK;
+}
+
 static int cortex_a_read_cpu_memory(struct target *target,
 	uint32_t address, uint32_t size,
-	uint32_t count, uint8_t *buffer)
+	uint32_t count, uint8_t *buffer, bool as_buffer)
 {
-	/* Read memory through the CPU. */
+	/* Read memory through the CPU. With as_buffer set, size must be 1 and
+	 * the access size is chosen per piece as for target_read_buffer(). */
 	int retval, final_retval;
 	struct armv7a_common *armv7a = target_to_armv7a(target);
 	struct arm *arm = &armv7a->arm;
@@ -2609,7 +2731,10 @@ static int cortex_a_read_cpu_memory(struct target *target,
 	if (retval != ERROR_OK)
 		goto out;
 
-	if (size == 4 && (address % 4) == 0) {
+	if (as_buffer) {
+		/* Byte buffer, split into aligned pieces in this session. */
+		retval = cortex_a_read_cpu_memory_buffer(target, address, count, buffer, &dscr);
+	} else if (size == 4 && (address % 4) == 0) {
 		/* We are doing a word-aligned transfer, so use fast mode. */
 		retval = cortex_a_read_cpu_memory_fast(target, count, buffer, &dscr);
 	} else {
@@ -2710,7 +2835,7 @@ static int cortex_a_read_phys_memory(struct target *target,
 
 	/* read memory through the CPU */
 	cortex_a_prep_memaccess(target, 1);
-	retval = cortex_a_read_cpu_memory(target, address, size, count, buffer);
+	retval = cortex_a_read_cpu_memory(target, address, size, count, buffer, false);
 	cortex_a_post_memaccess(target, 1);
 
 	return retval;
@@ -2726,7 +2851,7 @@ static int cortex_a_read_memory(struct target *target, target_addr_t address,
 		address, size, count);
 
 	cortex_a_prep_memaccess(target, 0);
-	retval = cortex_a_read_cpu_memory(target, address, size, count, buffer);
+	retval = cortex_a_read_cpu_memory(target, address, size, count, buffer, false);
 	cortex_a_post_memaccess(target, 0);
 
 	return retval;
@@ -2749,6 +2874,13 @@ static int cortex_a_read_memory_ahb(struct target *target, target_addr_t address
 	LOG_DEBUG("Reading memory at address " TARGET_ADDR_FMT "; size %" PRId32 "; count %" PRId32,
 		address, size, count);
 
+	/* the memory AP does not see dirty lines held in the data caches */
+	if (target->state == TARGET_HALTED) {
+		retval = armv7a_cache_auto_clean_on_read(target, address, size * count);
+		if (retval != ERROR_OK)
+			return retval;
+	}
+
 	/* determine if MMU was enabled on target stop */
 	if (!armv7a->is_armv7r) {
 		retval = cortex_a_mmu(target, &mmu_enabled);
@@ -2796,7 +2928,7 @@ static int cortex_a_write_phys_memory(struct target *target,
 
 	/* write memory through the CPU */
 	cortex_a_prep_memaccess(target, 1);
-	retval = cortex_a_write_cpu_memory(target, address, size, count, buffer);
+	retval = cortex_a_write_cpu_memory(target, address, size, count, buffer, false);
 	cortex_a_post_memaccess(target, 1);
 
 	return retval;
@@ -2815,7 +2947,7 @@ static int cortex_a_write_memory(struct target *target, target_addr_t address,
 	armv7a_cache_auto_flush_on_write(target, address, size * count);
 
 	cortex_a_prep_memaccess(target, 0);
-	retval = cortex_a_write_cpu_memory(target, address, size, count, buffer);
+	retval = cortex_a_write_cpu_memory(target, address, size, count, buffer, false);
 	cortex_a_post_memaccess(target, 0);
 	return retval;
 }
@@ -2837,6 +2969,14 @@ static int cortex_a_write_memory_ahb(struct target *target, target_addr_t addres
 	LOG_DEBUG("Writing memory at address " TARGET_ADDR_FMT "; size %" PRId32 "; count %" PRId32,
 		address, size, count);
 
+	/* the memory AP writes behind the data caches, so no line in the range
+	 * may stay valid (or dirty and later be evicted over the new data) */
+	if (target->state == TARGET_HALTED) {
+		retval = armv7a_cache_auto_flush_on_write(target, address, size * count);
+		if (retval != ERROR_OK)
+			return retval;
+	}
+
 	/* determine if MMU was enabled on target stop */
 	if (!armv7a->is_armv7r) {
 		retval = cortex_a_mmu(target, &mmu_enabled);
@@ -2868,8 +3008,21 @@ static int cortex_a_write_memory_ahb(struct target *target, target_addr_t addres
 static int cortex_a_read_buffer(struct target *target, target_addr_t address,
 				uint32_t count, uint8_t *buffer)
 {
+	struct armv7a_common *armv7a = target_to_armv7a(target);
+	uint8_t apsel = armv7a->arm.dap->apsel;
 	uint32_t size;
 
+	if (!armv7a->memory_ap_available || (apsel != armv7a->memory_ap->ap_num)) {
+		/* Read the whole buffer, unaligned head and tail included, in a
+		 * single pass through the CPU. */
+		if (!count)
+			return ERROR_OK;
+		cortex_a_prep_memaccess(target, 0);
+		int retval = cortex_a_read_cpu_memory(target, address, 1, count, buffer, true);
+		cortex_a_post_memaccess(target, 0);
+		return retval;
+	}
+
 	/* Align up to maximum 4 bytes. The loop condition makes sure the next pass
 	 * will have something to do with the size we leave to it. */
 	for (size = 1; size < 4 && count >= size * 2 + (address & size); size *= 2) {
@@ -2902,8 +3055,24 @@ static int cortex_a_read_buffer(struct target *target, target_addr_t address,
 static int cortex_a_write_buffer(struct target *target, target_addr_t address,
 				 uint32_t count, const uint8_t *buffer)
 {
+	struct armv7a_common *armv7a = target_to_armv7a(target);
+	uint8_t apsel = armv7a->arm.dap->apsel;
 	uint32_t size;
 
+	if (!armv7a->memory_ap_available || (apsel != armv7a->memory_ap->ap_num)) {
+		/* Write the whole buffer, unaligned head and tail included, in a
+		 * single pass through the CPU. */
+		if (!count)
+			return ERROR_OK;
+		int retval = armv7a_cache_auto_flush_on_write(target, address, count);
+		if (retval != ERROR_OK)
+			return retval;
+		cortex_a_prep_memaccess(target, 0);
+		retval = cortex_a_write_cpu_memory(target, address, 1, count, buffer, true);
+		cortex_a_post_memaccess(target, 0);
+		return retval;
+	}
+
 	/* Align up to maximum 4 bytes. The loop condition makes sure the next pass
 	 * will have something to do with the size we leave to it. */
 	for (size = 1; size < 4 && count >= size * 2 + (address & size); size *= 2) {
@@ -1683,6 +1683,7 @@ void cortex_m_deinit_target(struct target *target)
 
 	cortex_m_dwt_free(target);
 	armv7m_free_reg_cache(target);
+	armv7m_trace_free(target);
 
 	free(target->private_config);
 	free(cortex_m);
@@ -2505,6 +2506,8 @@ struct target_type cortexm_target = {
 	.write_memory = cortex_m_write_memory,
 	.checksum_memory = armv7m_checksum_memory,
 	.blank_check_memory = armv7m_blank_check_memory,
+	.checksum_memory_blocks = armv7m_checksum_memory_blocks,
+	.decompress_memory = armv7m_decompress_memory,
 
 	.run_algorithm = armv7m_run_algorithm,
 	.start_algorithm = armv7m_start_algorithm,
@@ -642,6 +642,31 @@ static struct etm_capture_driver *etm_capture_drivers[] = {
 	NULL
 };
 
+/* Decoded instructions of the trace image, looked up by address. Trace
+ * analysis revisits the same code over and over (loops, common functions),
+ * so each opcode only has to be read from the image and decoded once. */
+#define ETM_DECODE_CACHE_SIZE	4096
+/* bytes of straight-line code decoded at once on a cache miss */
+#define ETM_DECODE_BLOCK_SIZE	64
+
+struct etm_decode_cache_entry {
+	uint32_t pc;
+	int core_state;		/* 0 marks an unused entry */
+	struct arm_instruction instruction;
+};
+
+static struct etm_decode_cache_entry *etm_decode_cache_slot(struct etm_context *ctx,
+		uint32_t pc)
+{
+	return &ctx->decode_cache[(pc >> 1) % ETM_DECODE_CACHE_SIZE];
+}
+
+static void etm_decode_cache_free(struct etm_context *ctx)
+{
+	free(ctx->decode_cache);
+	ctx->decode_cache = NULL;
+}
+
 static int etm_read_instruction(struct etm_context *ctx, struct arm_instruction *instruction)
 {
 	int i;
@@ -653,6 +678,29 @@ static int etm_read_instruction(struct etm_context *ctx, struct arm_instruction
 	if (!ctx->image)
 		return ERROR_TRACE_IMAGE_UNAVAILABLE;
 
+	if (ctx->core_state == ARM_STATE_JAZELLE) {
+		LOG_ERROR("BUG: tracing of jazelle code not supported");
+		return ERROR_FAIL;
+	} else if (ctx->core_state != ARM_STATE_ARM && ctx->core_state != ARM_STATE_THUMB) {
+		LOG_ERROR("BUG: unknown core state encountered");
+		return ERROR_FAIL;
+	}
+
+	if (!ctx->decode_cache) {
+		ctx->decode_cache = calloc(ETM_DECODE_CACHE_SIZE, sizeof(*ctx->decode_cache));
+		if (!ctx->decode_cache) {
+			LOG_ERROR("Out of memory");
+			return ERROR_FAIL;
+		}
+	}
+
+	/* ARM_STATE_ARM is 0, so store the state off by one */
+	struct etm_decode_cache_entry *entry = etm_decode_cache_slot(ctx, ctx->current_pc);
+	if (entry->core_state == ctx->core_state + 1 && entry->pc == ctx->current_pc) {
+		*instruction = entry->instruction;
+		return ERROR_OK;
+	}
+
 	/* search for the section the current instruction belongs to */
 	for (i = 0; i < ctx->image->num_sections; i++) {
 		if ((ctx->image->sections[i].base_address <= ctx->current_pc) &&
@@ -668,36 +716,39 @@ static int etm_read_instruction(struct etm_context *ctx, struct arm_instruction
 		return ERROR_TRACE_INSTRUCTION_UNAVAILABLE;
 	}
 
-	if (ctx->core_state == ARM_STATE_ARM) {
-		uint8_t buf[4];
-		retval = image_read_section(ctx->image, section,
-				ctx->current_pc -
-				ctx->image->sections[section].base_address,
-				4, buf, &size_read);
-		if (retval != ERROR_OK) {
-			LOG_ERROR("error while reading instruction");
-			return ERROR_TRACE_INSTRUCTION_UNAVAILABLE;
-		}
-		opcode = target_buffer_get_u32(ctx->target, buf);
-		arm_evaluate_opcode(opcode, ctx->current_pc, instruction);
-	} else if (ctx->core_state == ARM_STATE_THUMB) {
-		uint8_t buf[2];
-		retval = image_read_section(ctx->image, section,
-				ctx->current_pc -
-				ctx->image->sections[section].base_address,
-				2, buf, &size_read);
-		if (retval != ERROR_OK) {
-			LOG_ERROR("error while reading instruction");
-			return ERROR_TRACE_INSTRUCTION_UNAVAILABLE;
+	/* decode a block of straight-line code starting at the current PC, it
+	 * is likely to be executed next */
+	unsigned int width = (ctx->core_state == ARM_STATE_ARM) ? 4 : 2;
+	uint32_t offset = ctx->current_pc - ctx->image->sections[section].base_address;
+	uint32_t len = MIN(ETM_DECODE_BLOCK_SIZE, ctx->image->sections[section].size - offset);
+	uint8_t buf[ETM_DECODE_BLOCK_SIZE];
+
+	len -= len % width;
+	if (len == 0)
+		return ERROR_TRACE_INSTRUCTION_UNAVAILABLE;
+
+	retval = image_read_section(ctx->image, section, offset, len, buf, &size_read);
+	if (retval != ERROR_OK || size_read < width) {
+		LOG_ERROR("error while reading instruction");
+		return ERROR_TRACE_INSTRUCTION_UNAVAILABLE;
+	}
+
+	for (uint32_t pos = 0; pos + width <= size_read; pos += width) {
+		uint32_t pc = ctx->current_pc + pos;
+		entry = etm_decode_cache_slot(ctx, pc);
+
+		if (width == 4) {
+			opcode = target_buffer_get_u32(ctx->target, buf + pos);
+			arm_evaluate_opcode(opcode, pc, &entry->instruction);
+		} else {
+			opcode = target_buffer_get_u16(ctx->target, buf + pos);
+			thumb_evaluate_opcode(opcode, pc, &entry->instruction);
 		}
-		opcode = target_buffer_get_u16(ctx->target, buf);
-		thumb_evaluate_opcode(opcode, ctx->current_pc, instruction);
-	} else if (ctx->core_state == ARM_STATE_JAZELLE) {
-		LOG_ERROR("BUG: tracing of jazelle code not supported");
-		return ERROR_FAIL;
-	} else {
-		LOG_ERROR("BUG: unknown core state encountered");
-		return ERROR_FAIL;
+		entry->pc = pc;
+		entry->core_state = ctx->core_state + 1;
+
+		if (pos == 0)
+			*instruction = entry->instruction;
 	}
 
 	return ERROR_OK;
@@ -859,7 +910,34 @@ static int etmv1_data(struct etm_context *ctx, int size, uint32_t *data)
 	return 0;
 }
 
-static int etmv1_analyze_trace(struct etm_context *ctx, struct command_context *cmd_ctx)
+/* Execution trace export: a header followed by one 8 byte record per
+ * traced instruction, all little endian:
+ *   u32 magic, u32 version
+ *   u32 address, u32 cycles (bits 0..23, saturated) | flags (bits 24..31)
+ */
+#define ETM_EXPORT_MAGIC		0x584d5445	/* "ETMX" */
+#define ETM_EXPORT_VERSION		1
+#define ETM_EXPORT_NOT_EXECUTED	(1 << 24)
+#define ETM_EXPORT_THUMB		(1 << 25)
+#define ETM_EXPORT_CYCLES_MASK	0x00ffffff
+
+/* writes a pair of little endian words to the export file */
+static int etm_export_write(struct fileio *export, uint32_t first, uint32_t second)
+{
+	uint8_t buf[8];
+	size_t size_written;
+
+	h_u32_to_le(buf, first);
+	h_u32_to_le(buf + 4, second);
+
+	int retval = fileio_write(export, sizeof(buf), buf, &size_written);
+	if (retval == ERROR_OK && size_written != sizeof(buf))
+		retval = ERROR_FAIL;
+	return retval;
+}
+
+static int etmv1_analyze_trace(struct etm_context *ctx, struct command_context *cmd_ctx,
+		struct fileio *export)
 {
 	int retval;
 	struct arm_instruction instruction;
@@ -1119,10 +1197,19 @@ static int etmv1_analyze_trace(struct etm_context *ctx, struct command_context *
 					(cycles == 1) ? "cycle" : "cycles");
 			}
 
-			command_print(cmd_ctx, "%s%s%s",
-				instruction.text,
-				(pipestat == STAT_IN) ? " (not executed)" : "",
-				cycles_text);
+			if (export) {
+				uint32_t info = MIN(cycles, ETM_EXPORT_CYCLES_MASK);
+				if (pipestat == STAT_IN)
+					info |= ETM_EXPORT_NOT_EXECUTED;
+				if (ctx->core_state == ARM_STATE_THUMB)
+					info |= ETM_EXPORT_THUMB;
+				if (etm_export_write(export, ctx->current_pc, info) != ERROR_OK)
+					return ERROR_FAIL;
+			} else
+				command_print(cmd_ctx, "%s%s%s",
+					instruction.text,
+					(pipestat == STAT_IN) ? " (not executed)" : "",
+					cycles_text);
 
 			ctx->current_pc = next_pc;
 
@@ -1675,6 +1762,7 @@ COMMAND_HANDLER(handle_etm_image_command)
 		free(etm_ctx->image);
 		command_print(CMD_CTX, "previously loaded image found and closed");
 	}
+	etm_decode_cache_free(etm_ctx);
 
 	etm_ctx->image = malloc(sizeof(struct image));
 	etm_ctx->image->base_address_set = 0;
@@ -1967,8 +2055,12 @@ COMMAND_HANDLER(handle_etm_analyze_command)
 	struct target *target;
 	struct arm *arm;
 	struct etm_context *etm_ctx;
+	struct fileio *export = NULL;
 	int retval;
 
+	if (CMD_ARGC > 1)
+		return ERROR_COMMAND_SYNTAX_ERROR;
+
 	target = get_current_target(CMD_CTX);
 	arm = target_to_arm(target);
 	if (!is_arm(arm)) {
@@ -1982,7 +2074,19 @@ COMMAND_HANDLER(handle_etm_analyze_command)
 		return ERROR_FAIL;
 	}
 
-	retval = etmv1_analyze_trace(etm_ctx, CMD_CTX);
+	if (CMD_ARGC == 1) {
+		if (fileio_open(&export, CMD_ARGV[0], FILEIO_WRITE, FILEIO_BINARY) != ERROR_OK)
+			return ERROR_FAIL;
+		if (etm_export_write(export, ETM_EXPORT_MAGIC, ETM_EXPORT_VERSION) != ERROR_OK) {
+			command_print(CMD_CTX, "failed to write %s", CMD_ARGV[0]);
+			fileio_close(export);
+			return ERROR_FAIL;
+		}
+	}
+
+	retval = etmv1_analyze_trace(etm_ctx, CMD_CTX, export);
+	if (export)
+		fileio_close(export);
 	if (retval != ERROR_OK) {
 		/* FIX! error should be reported inside etmv1_analyze_trace() */
 		switch (retval) {
@@ -2000,7 +2104,8 @@ COMMAND_HANDLER(handle_etm_analyze_command)
 			default:
 				command_print(CMD_CTX, "unknown error");
 		}
-	}
+	} else if (export)
+		command_print(CMD_CTX, "execution trace written to %s", CMD_ARGV[0]);
 
 	return retval;
 }
@@ -2081,8 +2186,9 @@ static const struct command_registration etm_exec_command_handlers[] = {
 		.name = "analyze",
 		.handler = handle_etm_analyze_command,
 		.mode = COMMAND_EXEC,
-		.usage = "",
-		.help = "analyze collected ETM trace",
+		.usage = "[export_filename]",
+		.help = "analyze collected ETM trace, optionally exporting "
+			"the executed instructions to a binary file",
 	},
 	{
 		.name = "image",
@@ -183,6 +183,7 @@ struct etm_context {
 	uint32_t last_branch_reason;	/* type of last branch encountered */
 	uint32_t last_ptr;		/* address of the last data access */
 	uint32_t last_instruction;	/* index of last executed (to calc timings) */
+	struct etm_decode_cache_entry *decode_cache;	/* decoded image instructions */
 };
 
 /* PIPESTAT values */
@@ -826,6 +826,8 @@ struct target_type hla_target = {
 	.write_memory = adapter_write_memory,
 	.checksum_memory = armv7m_checksum_memory,
 	.blank_check_memory = armv7m_blank_check_memory,
+	.checksum_memory_blocks = armv7m_checksum_memory_blocks,
+	.decompress_memory = armv7m_decompress_memory,
 
 	.run_algorithm = armv7m_run_algorithm,
 	.start_algorithm = armv7m_start_algorithm,
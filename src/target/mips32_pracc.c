@@ -911,59 +911,19 @@ int mips32_pracc_read_regs(struct mips_ejtag *ejtag_info, uint32_t *regs)
 	return ctx.retval;
 }
 
-/* fastdata upload/download requires an initialized working area
- * to load the download code; it should not be called otherwise
- * fetch order from the fastdata area
- * 1. start addr
- * 2. end addr
- * 3. data ...
- */
-int mips32_pracc_fastdata_xfer(struct mips_ejtag *ejtag_info, struct working_area *source,
-		int write_t, uint32_t addr, int count, uint32_t *buf)
+/* Runs the fastdata handler loaded at source once over count words.
+ * Every fastdata scan shifts out the PrAcc bit, telling whether the
+ * processor took the word; those bits are checked once per batch of
+ * MIPS32_FASTDATA_BATCH_WORDS scans. The handler only advances on
+ * accepted words, so the words accepted behind a dropped one went to the
+ * addresses before their own. The next batch resumes at the handler's
+ * position, and the words that got misplaced are returned in
+ * redo_first/redo_count for the caller to transfer again. */
+static int mips32_pracc_fastdata_run(struct mips_ejtag *ejtag_info, struct working_area *source,
+		int write_t, uint32_t addr, int count, uint32_t *buf,
+		int *redo_first, int *redo_count)
 {
 	uint32_t isa = ejtag_info->isa ? 1 : 0;
-	uint32_t handler_code[] = {
-		/* r15 points to the start of this code */
-		MIPS32_SW(isa, 8, MIPS32_FASTDATA_HANDLER_SIZE - 4, 15),
-		MIPS32_SW(isa, 9, MIPS32_FASTDATA_HANDLER_SIZE - 8, 15),
-		MIPS32_SW(isa, 10, MIPS32_FASTDATA_HANDLER_SIZE - 12, 15),
-		MIPS32_SW(isa, 11, MIPS32_FASTDATA_HANDLER_SIZE - 16, 15),
-		/* start of fastdata area in t0 */
-		MIPS32_LUI(isa, 8, UPPER16(MIPS32_PRACC_FASTDATA_AREA)),
-		MIPS32_ORI(isa, 8, 8, LOWER16(MIPS32_PRACC_FASTDATA_AREA)),
-		MIPS32_LW(isa, 9, 0, 8),						/* start addr in t1 */
-		MIPS32_LW(isa, 10, 0, 8),						/* end addr to t2 */
-					/* loop: */
-		write_t ? MIPS32_LW(isa, 11, 0, 8) : MIPS32_LW(isa, 11, 0, 9),	/* from xfer area : from memory */
-		write_t ? MIPS32_SW(isa, 11, 0, 9) : MIPS32_SW(isa, 11, 0, 8),	/* to memory      : to xfer area */
-
-		MIPS32_BNE(isa, 10, 9, NEG16(3 << isa)),			/* bne $t2,t1,loop */
-		MIPS32_ADDI(isa, 9, 9, 4),					/* addi t1,t1,4 */
-
-		MIPS32_LW(isa, 8, MIPS32_FASTDATA_HANDLER_SIZE - 4, 15),
-		MIPS32_LW(isa, 9, MIPS32_FASTDATA_HANDLER_SIZE - 8, 15),
-		MIPS32_LW(isa, 10, MIPS32_FASTDATA_HANDLER_SIZE - 12, 15),
-		MIPS32_LW(isa, 11, MIPS32_FASTDATA_HANDLER_SIZE - 16, 15),
-
-		MIPS32_LUI(isa, 15, UPPER16(MIPS32_PRACC_TEXT)),
-		MIPS32_ORI(isa, 15, 15, LOWER16(MIPS32_PRACC_TEXT) | isa),	/* isa bit for JR instr */
-		MIPS32_JR(isa, 15),								/* jr start */
-		MIPS32_MFC0(isa, 15, 31, 0),					/* move COP0 DeSave to $15 */
-	};
-
-	if (source->size < MIPS32_FASTDATA_HANDLER_SIZE)
-		return ERROR_TARGET_RESOURCE_NOT_AVAILABLE;
-
-	pracc_swap16_array(ejtag_info, handler_code, ARRAY_SIZE(handler_code));
-		/* write program into RAM */
-	if (write_t != ejtag_info->fast_access_save) {
-		mips32_pracc_write_mem(ejtag_info, source->address, 4, ARRAY_SIZE(handler_code), handler_code);
-		/* save previous operation to speed to any consecutive read/writes */
-		ejtag_info->fast_access_save = write_t;
-	}
-
-	LOG_DEBUG("%s using 0x%.8" TARGET_PRIxADDR " for write handler", __func__, source->address);
-
 	uint32_t jmp_code[] = {
 		MIPS32_LUI(isa, 15, UPPER16(source->address)),			/* load addr of jump in $15 */
 		MIPS32_ORI(isa, 15, 15, LOWER16(source->address) | isa),	/* isa bit for JR instr */
@@ -971,6 +931,9 @@ int mips32_pracc_fastdata_xfer(struct mips_ejtag *ejtag_info, struct working_are
 		isa ? MIPS32_XORI(isa, 15, 15, 1) : MIPS32_NOP,	/* drop isa bit, needed for LW/SW instructions */
 	};
 
+	*redo_first = 0;
+	*redo_count = 0;
+
 	pracc_swap16_array(ejtag_info, jmp_code, ARRAY_SIZE(jmp_code));
 
 	/* execute jump code, with no address check */
@@ -998,7 +961,7 @@ int mips32_pracc_fastdata_xfer(struct mips_ejtag *ejtag_info, struct working_are
 	/* Send the load start address */
 	uint32_t val = addr;
 	mips_ejtag_set_instr(ejtag_info, EJTAG_INST_FASTDATA);
-	mips_ejtag_fastdata_scan(ejtag_info, 1, &val);
+	mips_ejtag_fastdata_scan(ejtag_info, 1, &val, NULL);
 
 	retval = wait_for_pracc_rw(ejtag_info);
 	if (retval != ERROR_OK)
@@ -1007,29 +970,148 @@ int mips32_pracc_fastdata_xfer(struct mips_ejtag *ejtag_info, struct working_are
 	/* Send the load end address */
 	val = addr + (count - 1) * 4;
 	mips_ejtag_set_instr(ejtag_info, EJTAG_INST_FASTDATA);
-	mips_ejtag_fastdata_scan(ejtag_info, 1, &val);
+	mips_ejtag_fastdata_scan(ejtag_info, 1, &val, NULL);
 
 	unsigned num_clocks = 0;	/* like in legacy code */
 	if (ejtag_info->mode != 0)
 		num_clocks = ((uint64_t)(ejtag_info->scan_delay) * jtag_get_speed_khz() + 500000) / 1000000;
 
-	for (int i = 0; i < count; i++) {
-		jtag_add_clocks(num_clocks);
-		mips_ejtag_fastdata_scan(ejtag_info, write_t, buf++);
+	uint8_t *pracc = malloc(MIN(count, MIPS32_FASTDATA_BATCH_WORDS));
+	if (pracc == NULL) {
+		LOG_ERROR("Out of memory");
+		return ERROR_FAIL;
 	}
 
-	retval = jtag_execute_queue();
-	if (retval != ERROR_OK) {
-		LOG_ERROR("fastdata load failed");
-		return retval;
+	int done = 0;	/* words consumed by the handler */
+	int redo_end = 0;
+	while (done < count) {
+		int batch = MIN(count - done, MIPS32_FASTDATA_BATCH_WORDS);
+
+		for (int i = 0; i < batch; i++) {
+			jtag_add_clocks(num_clocks);
+			mips_ejtag_fastdata_scan(ejtag_info, write_t, buf + done + i, pracc + i);
+		}
+
+		retval = jtag_execute_queue();
+		if (retval != ERROR_OK) {
+			LOG_ERROR("fastdata load failed");
+			free(pracc);
+			return retval;
+		}
+
+		int accepted = 0;
+		int first_dropped = batch;
+		for (int i = 0; i < batch; i++) {
+			if (pracc[i] & 1)
+				accepted++;
+			else if (first_dropped == batch)
+				first_dropped = i;
+		}
+
+		if (accepted == 0) {
+			LOG_ERROR("fastdata: processor stopped accepting data at 0x%8.8" PRIx32,
+					addr + done * 4);
+			retval = ERROR_FAIL;
+			break;
+		}
+
+		/* words accepted behind the first drop landed one slot early or more */
+		if (accepted > first_dropped) {
+			if (redo_end == 0)
+				*redo_first = done + first_dropped;
+			redo_end = done + accepted;
+		}
+
+		done += accepted;
 	}
+	free(pracc);
 
-	retval = mips32_pracc_read_ctrl_addr(ejtag_info);
-	if (retval != ERROR_OK)
-		return retval;
+	/* a stalled run gets the same exit check as a completed one */
+	int retval2 = mips32_pracc_read_ctrl_addr(ejtag_info);
+	if (retval == ERROR_OK)
+		retval = retval2;
 
-	if (ejtag_info->pa_addr != MIPS32_PRACC_TEXT)
+	if (retval2 == ERROR_OK && ejtag_info->pa_addr != MIPS32_PRACC_TEXT)
 		LOG_ERROR("mini program did not return to start");
 
+	if (redo_end)
+		*redo_count = redo_end - *redo_first;
+
 	return retval;
 }
+
+/* fastdata upload/download requires an initialized working area
+ * to load the download code; it should not be called otherwise
+ * fetch order from the fastdata area
+ * 1. start addr
+ * 2. end addr
+ * 3. data ...
+ */
+int mips32_pracc_fastdata_xfer(struct mips_ejtag *ejtag_info, struct working_area *source,
+		int write_t, uint32_t addr, int count, uint32_t *buf)
+{
+	uint32_t isa = ejtag_info->isa ? 1 : 0;
+	uint32_t handler_code[] = {
+		/* r15 points to the start of this code */
+		MIPS32_SW(isa, 8, MIPS32_FASTDATA_HANDLER_SIZE - 4, 15),
+		MIPS32_SW(isa, 9, MIPS32_FASTDATA_HANDLER_SIZE - 8, 15),
+		MIPS32_SW(isa, 10, MIPS32_FASTDATA_HANDLER_SIZE - 12, 15),
+		MIPS32_SW(isa, 11, MIPS32_FASTDATA_HANDLER_SIZE - 16, 15),
+		/* start of fastdata area in t0 */
+		MIPS32_LUI(isa, 8, UPPER16(MIPS32_PRACC_FASTDATA_AREA)),
+		MIPS32_ORI(isa, 8, 8, LOWER16(MIPS32_PRACC_FASTDATA_AREA)),
+		MIPS32_LW(isa, 9, 0, 8),						/* start addr in t1 */
+		MIPS32_LW(isa, 10, 0, 8),						/* end addr to t2 */
+					/* loop: */
+		write_t ? MIPS32_LW(isa, 11, 0, 8) : MIPS32_LW(isa, 11, 0, 9),	/* from xfer area : from memory */
+		write_t ? MIPS32_SW(isa, 11, 0, 9) : MIPS32_SW(isa, 11, 0, 8),	/* to memory      : to xfer area */
+
+		MIPS32_BNE(isa, 10, 9, NEG16(3 << isa)),			/* bne $t2,t1,loop */
+		MIPS32_ADDI(isa, 9, 9, 4),					/* addi t1,t1,4 */
+
+		MIPS32_LW(isa, 8, MIPS32_FASTDATA_HANDLER_SIZE - 4, 15),
+		MIPS32_LW(isa, 9, MIPS32_FASTDATA_HANDLER_SIZE - 8, 15),
+		MIPS32_LW(isa, 10, MIPS32_FASTDATA_HANDLER_SIZE - 12, 15),
+		MIPS32_LW(isa, 11, MIPS32_FASTDATA_HANDLER_SIZE - 16, 15),
+
+		MIPS32_LUI(isa, 15, UPPER16(MIPS32_PRACC_TEXT)),
+		MIPS32_ORI(isa, 15, 15, LOWER16(MIPS32_PRACC_TEXT) | isa),	/* isa bit for JR instr */
+		MIPS32_JR(isa, 15),								/* jr start */
+		MIPS32_MFC0(isa, 15, 31, 0),					/* move COP0 DeSave to $15 */
+	};
+
+	if (source->size < MIPS32_FASTDATA_HANDLER_SIZE)
+		return ERROR_TARGET_RESOURCE_NOT_AVAILABLE;
+
+	pracc_swap16_array(ejtag_info, handler_code, ARRAY_SIZE(handler_code));
+		/* write program into RAM */
+	if (write_t != ejtag_info->fast_access_save) {
+		mips32_pracc_write_mem(ejtag_info, source->address, 4, ARRAY_SIZE(handler_code), handler_code);
+		/* save previous operation to speed to any consecutive read/writes */
+		ejtag_info->fast_access_save = write_t;
+	}
+
+	LOG_DEBUG("%s using 0x%.8" TARGET_PRIxADDR " for write handler", __func__, source->address);
+
+	/* rerun the handler over the words misplaced after a drop; if that
+	 * keeps happening, the caller falls back to the slow way */
+	for (int pass = 0; ; pass++) {
+		int redo_first, redo_count;
+		int retval = mips32_pracc_fastdata_run(ejtag_info, source, write_t,
+				addr, count, buf, &redo_first, &redo_count);
+		if (retval != ERROR_OK || redo_count == 0)
+			return retval;
+
+		if (pass == MIPS32_FASTDATA_RETRIES) {
+			LOG_WARNING("fastdata: %d words at 0x%8.8" PRIx32 " were not transferred",
+					redo_count, addr + redo_first * 4);
+			return ERROR_FAIL;
+		}
+
+		LOG_DEBUG("fastdata: redoing %d words at 0x%8.8" PRIx32,
+				redo_count, addr + redo_first * 4);
+		addr += redo_first * 4;
+		buf += redo_first;
+		count = redo_count;
+	}
+}
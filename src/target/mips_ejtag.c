@@ -386,7 +386,11 @@ int mips_ejtag_init(struct mips_ejtag *ejtag_info)
 	return ERROR_OK;
 }
 
-int mips_ejtag_fastdata_scan(struct mips_ejtag *ejtag_info, int write_t, uint32_t *data)
+/* pracc, when not NULL, receives the PrAcc bit shifted out with the word:
+ * 1 if the processor had an access pending and took the word, 0 if the word
+ * was dropped. */
+int mips_ejtag_fastdata_scan(struct mips_ejtag *ejtag_info, int write_t, uint32_t *data,
+		uint8_t *pracc)
 {
 	assert(ejtag_info->tap != NULL);
 	struct jtag_tap *tap = ejtag_info->tap;
@@ -398,7 +402,7 @@ int mips_ejtag_fastdata_scan(struct mips_ejtag *ejtag_info, int write_t, uint32_
 
 	uint8_t spracc = 0;
 	fields[0].out_value = &spracc;
-	fields[0].in_value = NULL;
+	fields[0].in_value = pracc;
 
 	/* processor access data register 32 bit */
 	fields[1].num_bits = 32;
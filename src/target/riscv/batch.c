@@ -34,6 +34,7 @@ void riscv_batch_free(struct riscv_batch *batch)
 	free(batch->data_in);
 	free(batch->data_out);
 	free(batch->fields);
+	free(batch->read_keys);
 	free(batch);
 }
 
@@ -97,14 +98,12 @@ size_t riscv_batch_add_dmi_read(struct riscv_batch *batch, unsigned address)
 	batch->last_scan = RISCV_SCAN_TYPE_READ;
 	batch->used_scans++;
 
-	/* FIXME We get the read response back on the next scan.  For now I'm
-	 * just sticking a NOP in there, but this should be coelesced away. */
-	riscv_batch_add_nop(batch);
-
-	batch->read_keys[batch->read_keys_used] = batch->used_scans - 1;
+	/* We get the read response back on the next scan, which is either the
+	 * next access in this batch or the NOP added by riscv_batch_run(). */
+	batch->read_keys[batch->read_keys_used] = batch->used_scans;
 	LOG_DEBUG("read key %u for batch 0x%p is %u (0x%p)",
-			(unsigned) batch->read_keys_used, batch, (unsigned) (batch->used_scans - 1),
-			batch->data_in + sizeof(uint64_t) * (batch->used_scans + 1));
+			(unsigned) batch->read_keys_used, batch, (unsigned) batch->used_scans,
+			batch->data_in + sizeof(uint64_t) * batch->used_scans);
 	return batch->read_keys_used++;
 }
 
@@ -124,6 +123,15 @@ uint64_t riscv_batch_get_dmi_read(struct riscv_batch *batch, size_t key)
 		((uint64_t) base[7]) << 56;
 }
 
+unsigned riscv_batch_get_dmi_status(struct riscv_batch *batch)
+{
+	if (batch->used_scans == 0)
+		return 0;
+	const struct scan_field *field = batch->fields + batch->used_scans - 1;
+	uint64_t in = buf_get_u64(field->in_value, 0, field->num_bits);
+	return get_field(in, DTM_DMI_OP);
+}
+
 void riscv_batch_add_nop(struct riscv_batch *batch)
 {
 	assert(batch->used_scans < batch->allocated_scans);
@@ -54,10 +54,17 @@ int riscv_batch_run(struct riscv_batch *batch);
 void riscv_batch_add_dmi_write(struct riscv_batch *batch, unsigned address, uint64_t data);
 
 /* DMI reads must be handled in two parts: the first one schedules a read and
- * provides a key, the second one actually obtains the value of that read .*/
+ * provides a key, the second one actually obtains the value of that read.
+ * The value is the whole scan captured with the read result, so callers can
+ * check the DMI op status alongside the data. */
 size_t riscv_batch_add_dmi_read(struct riscv_batch *batch, unsigned address);
 uint64_t riscv_batch_get_dmi_read(struct riscv_batch *batch, size_t key);
 
+/* Returns the DMI op status captured by the last scan of a batch that has
+ * been run. DMI errors are sticky, so this tells whether any access of the
+ * batch failed. */
+unsigned riscv_batch_get_dmi_status(struct riscv_batch *batch);
+
 /* Scans in a NOP. */
 void riscv_batch_add_nop(struct riscv_batch *batch);
 
@@ -43,6 +43,9 @@ static int riscv013_halt_current_hart(struct target *target);
 static int riscv013_resume_current_hart(struct target *target);
 static int riscv013_step_current_hart(struct target *target);
 static int riscv013_on_halt(struct target *target);
+static int riscv013_halt_all_harts(struct target *target);
+static int riscv013_resume_all_harts(struct target *target);
+static int riscv013_snapshot_registers(struct target *target);
 static int riscv013_on_step(struct target *target);
 static int riscv013_on_resume(struct target *target);
 static bool riscv013_is_halted(struct target *target);
@@ -85,6 +88,14 @@ static int write_memory(struct target *target, target_addr_t address,
 
 #define RISCV013_INFO(r) riscv013_info_t *r = get_info(target)
 
+/* Largest number of DMI reads put in a single batch by memory reads. */
+#define RISCV013_MAX_BATCH_READS	1024
+/* Largest number of DMI accesses put in a single system bus access batch. */
+#define RISCV013_MAX_SBA_BATCH_SCANS	1024
+/* Number of batches completing without any busy response before the busy
+ * delays are decreased again. */
+#define RISCV013_CLEAN_BATCHES_BEFORE_DECAY	8
+
 /*** JTAG registers. ***/
 
 typedef enum {
@@ -207,6 +218,10 @@ typedef struct {
 	/* The width of the hartsel field. */
 	unsigned hartsellen;
 
+	/* The DM implements the hart array mask, so that several harts can be
+	 * halted or resumed with a single request. */
+	bool hasel_supported;
+
 	/* DM that provides access to this target. */
 	dm013_info_t *dm;
 } riscv013_info_t;
@@ -630,6 +645,20 @@ static void increase_ac_busy_delay(struct target *target)
 			info->ac_busy_delay);
 }
 
+/**
+ * Undo some of the increases above once the target has kept up for a while,
+ * so that a single slow access doesn't slow down all the following ones.
+ */
+static void decrease_busy_delays(struct target *target)
+{
+	riscv013_info_t *info = get_info(target);
+	info->dmi_busy_delay -= info->dmi_busy_delay / 10;
+	info->ac_busy_delay -= info->ac_busy_delay / 10;
+	LOG_DEBUG("dtmcontrol_idle=%d, dmi_busy_delay=%d, ac_busy_delay=%d",
+			info->dtmcontrol_idle, info->dmi_busy_delay,
+			info->ac_busy_delay);
+}
+
 uint32_t abstract_register_size(unsigned width)
 {
 	switch (width) {
@@ -1368,11 +1397,18 @@ static int examine(struct target *target)
 	}
 
 	dmi_write(target, DMI_DMCONTROL, DMI_DMCONTROL_HARTSELLO |
-			DMI_DMCONTROL_HARTSELHI | DMI_DMCONTROL_DMACTIVE);
+			DMI_DMCONTROL_HARTSELHI | DMI_DMCONTROL_DMACTIVE |
+			DMI_DMCONTROL_HASEL);
 	uint32_t dmcontrol;
 	if (dmi_read(target, &dmcontrol, DMI_DMCONTROL) != ERROR_OK)
 		return ERROR_FAIL;
 
+	/* hasel is WARZ when the hart array mask isn't implemented. */
+	info->hasel_supported = get_field(dmcontrol, DMI_DMCONTROL_HASEL);
+	LOG_DEBUG("hasel_supported=%d", info->hasel_supported);
+	dmi_write(target, DMI_DMCONTROL,
+			set_hartsel(DMI_DMCONTROL_DMACTIVE, dm->current_hartid));
+
 	if (!get_field(dmcontrol, DMI_DMCONTROL_DMACTIVE)) {
 		LOG_ERROR("Debug Module did not become active. dmcontrol=0x%x",
 				dmcontrol);
@@ -1565,6 +1601,9 @@ static int init_target(struct command_context *cmd_ctx,
 	generic_info->resume_current_hart = &riscv013_resume_current_hart;
 	generic_info->step_current_hart = &riscv013_step_current_hart;
 	generic_info->on_halt = &riscv013_on_halt;
+	generic_info->halt_all_harts = &riscv013_halt_all_harts;
+	generic_info->resume_all_harts = &riscv013_resume_all_harts;
+	generic_info->snapshot_registers = &riscv013_snapshot_registers;
 	generic_info->on_resume = &riscv013_on_resume;
 	generic_info->on_step = &riscv013_on_step;
 	generic_info->halt_reason = &riscv013_halt_reason;
@@ -1772,37 +1811,6 @@ static void log_memory_access(target_addr_t address, uint64_t value,
 	LOG_DEBUG(fmt, value);
 }
 
-/* Read the relevant sbdata regs depending on size, and put the results into
- * buffer. */
-static int read_memory_bus_word(struct target *target, target_addr_t address,
-		uint32_t size, uint8_t *buffer)
-{
-	uint32_t value;
-	if (size > 12) {
-		if (dmi_read(target, &value, DMI_SBDATA3) != ERROR_OK)
-			return ERROR_FAIL;
-		write_to_buf(buffer + 12, value, 4);
-		log_memory_access(address + 12, value, 4, true);
-	}
-	if (size > 8) {
-		if (dmi_read(target, &value, DMI_SBDATA2) != ERROR_OK)
-			return ERROR_FAIL;
-		write_to_buf(buffer + 8, value, 4);
-		log_memory_access(address + 8, value, 4, true);
-	}
-	if (size > 4) {
-		if (dmi_read(target, &value, DMI_SBDATA1) != ERROR_OK)
-			return ERROR_FAIL;
-		write_to_buf(buffer + 4, value, 4);
-		log_memory_access(address + 4, value, 4, true);
-	}
-	if (dmi_read(target, &value, DMI_SBDATA0) != ERROR_OK)
-		return ERROR_FAIL;
-	write_to_buf(buffer, value, MIN(size, 4));
-	log_memory_access(address, value, MIN(size, 4), true);
-	return ERROR_OK;
-}
-
 static uint32_t sb_sbaccess(unsigned size_bytes)
 {
 	switch (size_bytes) {
@@ -1951,8 +1959,55 @@ static int read_memory_bus_v0(struct target *target, target_addr_t address,
 	return ERROR_OK;
 }
 
+/* Number of sbdata registers accessed for each word of the given size. */
+static unsigned sb_data_regs(uint32_t size)
+{
+	return DIV_ROUND_UP(size, 4);
+}
+
+/* Queue reads of the relevant sbdata regs depending on size into batch.
+ * sbdata0 is read last, as reading it may trigger the next bus read. Returns
+ * the key of the first read. */
+static size_t sb_batch_add_word_read(struct riscv_batch *batch, uint32_t size)
+{
+	int last = sb_data_regs(size) - 1;
+	size_t key = riscv_batch_add_dmi_read(batch, DMI_SBDATA0 + last);
+	for (int i = last - 1; i >= 0; i--)
+		riscv_batch_add_dmi_read(batch, DMI_SBDATA0 + i);
+	return key;
+}
+
+/* Returns true if all the reads queued by sb_batch_add_word_read() came back
+ * successfully. */
+static bool sb_batch_word_read_ok(struct riscv_batch *batch, size_t key,
+		uint32_t size)
+{
+	for (unsigned i = 0; i < sb_data_regs(size); i++) {
+		uint64_t dmi_out = riscv_batch_get_dmi_read(batch, key + i);
+		if (get_field(dmi_out, DTM_DMI_OP) != DMI_STATUS_SUCCESS)
+			return false;
+	}
+	return true;
+}
+
+/* Put the values read by sb_batch_add_word_read() into buffer. */
+static void sb_batch_get_word(struct riscv_batch *batch, size_t key,
+		target_addr_t address, uint32_t size, uint8_t *buffer)
+{
+	for (int i = sb_data_regs(size) - 1; i >= 0; i--) {
+		uint64_t dmi_out = riscv_batch_get_dmi_read(batch, key++);
+		uint32_t value = get_field(dmi_out, DTM_DMI_DATA);
+		write_to_buf(buffer + 4 * i, value, MIN(size - 4 * i, 4));
+		log_memory_access(address + 4 * i, value, MIN(size - 4 * i, 4), true);
+	}
+}
+
 /**
  * Read the requested memory using the system bus interface.
+ *
+ * The reads are streamed with sbautoincrement and sbreadondata, in batches of
+ * DMI scans. sbcs is only checked once per batch. If the bus or the DMI was
+ * busy, the transfer is restarted from the first word that wasn't received.
  */
 static int read_memory_bus_v1(struct target *target, target_addr_t address,
 		uint32_t size, uint32_t count, uint8_t *buffer)
@@ -1960,64 +2015,148 @@ static int read_memory_bus_v1(struct target *target, target_addr_t address,
 	RISCV013_INFO(info);
 	target_addr_t next_address = address;
 	target_addr_t end_address = address + count * size;
+	size_t words_per_batch = MAX(RISCV013_MAX_SBA_BATCH_SCANS /
+			(sb_data_regs(size) + 1), 1);
+	size_t *keys = malloc(words_per_batch * sizeof(*keys));
+	bool setup_needed = true;
+	bool readondata = false;
+	unsigned batches = 0;
+
+	if (!keys) {
+		LOG_ERROR("Out of memory");
+		return ERROR_FAIL;
+	}
+
+	uint32_t access = set_field(0, DMI_SBCS_SBREADONADDR, 1);
+	access |= sb_sbaccess(size);
+	access = set_field(access, DMI_SBCS_SBAUTOINCREMENT, 1);
 
 	while (next_address < end_address) {
-		uint32_t sbcs = set_field(0, DMI_SBCS_SBREADONADDR, 1);
-		sbcs |= sb_sbaccess(size);
-		sbcs = set_field(sbcs, DMI_SBCS_SBAUTOINCREMENT, 1);
-		sbcs = set_field(sbcs, DMI_SBCS_SBREADONDATA, count > 1);
-		dmi_write(target, DMI_SBCS, sbcs);
-
-		/* This address write will trigger the first read. */
-		sb_write_address(target, next_address);
-
-		if (info->bus_master_read_delay) {
-			jtag_add_runtest(info->bus_master_read_delay, TAP_IDLE);
-			if (jtag_execute_queue() != ERROR_OK) {
-				LOG_ERROR("Failed to scan idle sequence");
-				return ERROR_FAIL;
+		uint32_t first = (next_address - address) / size;
+
+		if (setup_needed) {
+			readondata = count - first > 1;
+			dmi_write(target, DMI_SBCS, set_field(access,
+						DMI_SBCS_SBREADONDATA, readondata));
+
+			/* This address write will trigger the first read. */
+			sb_write_address(target, next_address);
+
+			if (info->bus_master_read_delay) {
+				jtag_add_runtest(info->bus_master_read_delay, TAP_IDLE);
+				if (jtag_execute_queue() != ERROR_OK) {
+					LOG_ERROR("Failed to scan idle sequence");
+					free(keys);
+					return ERROR_FAIL;
+				}
 			}
+			setup_needed = false;
 		}
 
-		for (uint32_t i = (next_address - address) / size; i < count - 1; i++) {
-			read_memory_bus_word(target, address + i * size, size,
-					buffer + i * size);
+		/* Every read of sbdata0 triggers the next bus read, and the stream
+		 * carries on across batches. Only the read of the last word must
+		 * not trigger another one. */
+		uint32_t words = MIN(count - first, words_per_batch);
+		struct riscv_batch *batch = riscv_batch_alloc(target,
+				words * (sb_data_regs(size) + 1),
+				info->dmi_busy_delay + info->bus_master_read_delay);
+		for (uint32_t i = 0; i < words; i++) {
+			if (first + i == count - 1 && readondata) {
+				riscv_batch_add_dmi_write(batch, DMI_SBCS, access);
+				readondata = false;
+			}
+			keys[i] = sb_batch_add_word_read(batch, size);
 		}
 
-		sbcs = set_field(sbcs, DMI_SBCS_SBREADONDATA, 0);
-		dmi_write(target, DMI_SBCS, sbcs);
-
-		read_memory_bus_word(target, address + (count - 1) * size, size,
-				buffer + (count - 1) * size);
-
-		if (read_sbcs_nonbusy(target, &sbcs) != ERROR_OK)
+		if (riscv_batch_run(batch) != ERROR_OK) {
+			riscv_batch_free(batch);
+			free(keys);
+			return ERROR_FAIL;
+		}
+		batches++;
+
+		/* DMI busy is sticky, so only the words before the first failed
+		 * read are valid. The read of sbcs below clears the busy state and
+		 * increases dmi_busy_delay. */
+		uint32_t good_words = 0;
+		while (good_words < words &&
+				sb_batch_word_read_ok(batch, keys[good_words], size))
+			good_words++;
+
+		uint32_t sbcs;
+		if (read_sbcs_nonbusy(target, &sbcs) != ERROR_OK) {
+			riscv_batch_free(batch);
+			free(keys);
 			return ERROR_FAIL;
+		}
 
 		if (get_field(sbcs, DMI_SBCS_SBBUSYERROR)) {
-			/* We read while the target was busy. Slow down and try again. */
+			/* We read while the target was busy, so none of the values of
+			 * this batch can be trusted. Slow down and try again. */
+			riscv_batch_free(batch);
 			dmi_write(target, DMI_SBCS, DMI_SBCS_SBBUSYERROR);
-			next_address = sb_read_address(target);
 			info->bus_master_read_delay += info->bus_master_read_delay / 10 + 1;
+			setup_needed = true;
 			continue;
 		}
 
 		unsigned error = get_field(sbcs, DMI_SBCS_SBERROR);
-		if (error == 0) {
-			next_address = end_address;
-		} else {
+		if (error != 0) {
 			/* Some error indicating the bus access failed, but not because of
 			 * something we did wrong. */
+			riscv_batch_free(batch);
+			free(keys);
 			dmi_write(target, DMI_SBCS, DMI_SBCS_SBERROR);
 			return ERROR_FAIL;
 		}
+
+		for (uint32_t i = 0; i < good_words; i++) {
+			target_addr_t offset = (first + i) * size;
+			sb_batch_get_word(batch, keys[i], address + offset, size,
+					buffer + offset);
+		}
+		riscv_batch_free(batch);
+
+		next_address += good_words * size;
+		if (good_words < words) {
+			LOG_DEBUG("DMI busy after %d of %d words, restarting at 0x%"
+					TARGET_PRIxADDR, good_words, words, next_address);
+			setup_needed = true;
+		}
 	}
 
+	LOG_DEBUG("read %d words in %u batches, bus_master_read_delay=%d",
+			count, batches, info->bus_master_read_delay);
+	free(keys);
+	return ERROR_OK;
+}
+
+/**
+ * Write the address to S0, execute the program buffer once, and turn on
+ * autoexec so that each read of DMI_DATA0 executes it again.
+ */
+static int read_memory_progbuf_start(struct target *target,
+		target_addr_t address, uint32_t command)
+{
+	int result = register_write_direct(target, GDB_REGNO_S0, address);
+	if (result != ERROR_OK)
+		return result;
+	result = execute_abstract_command(target, command);
+	if (result != ERROR_OK)
+		return result;
+
+	/* First read has just triggered. Result is in s1. */
+
+	dmi_write(target, DMI_ABSTRACTAUTO,
+			1 << DMI_ABSTRACTAUTO_AUTOEXECDATA_OFFSET);
 	return ERROR_OK;
 }
 
 /**
  * Read the requested memory, taking care to execute every read exactly once,
- * even if cmderr=busy is encountered.
+ * even if cmderr=busy is encountered. When the DMI itself reports busy, the
+ * values in flight are lost, and the words that weren't received yet are
+ * read again starting from the first missing one.
  */
 static int read_memory_progbuf(struct target *target, target_addr_t address,
 		uint32_t size, uint32_t count, uint8_t *buffer)
@@ -2067,21 +2206,13 @@ static int read_memory_progbuf(struct target *target, target_addr_t address,
 	riscv_program_write(&program);
 
 	/* Write address to S0, and execute buffer. */
-	result = register_write_direct(target, GDB_REGNO_S0, address);
-	if (result != ERROR_OK)
-		goto error;
 	uint32_t command = access_register_command(GDB_REGNO_S1, riscv_xlen(target),
 				AC_ACCESS_REGISTER_TRANSFER |
 				AC_ACCESS_REGISTER_POSTEXEC);
-	result = execute_abstract_command(target, command);
+	result = read_memory_progbuf_start(target, address, command);
 	if (result != ERROR_OK)
 		goto error;
 
-	/* First read has just triggered. Result is in s1. */
-
-	dmi_write(target, DMI_ABSTRACTAUTO,
-			1 << DMI_ABSTRACTAUTO_AUTOEXECDATA_OFFSET);
-
 	/* read_addr is the next address that the hart will read from, which is the
 	 * value in s0. */
 	riscv_addr_t read_addr = address + size;
@@ -2089,6 +2220,10 @@ static int read_memory_progbuf(struct target *target, target_addr_t address,
 	riscv_addr_t receive_addr = address;
 	riscv_addr_t fin_addr = address + (count * size);
 	unsigned skip = 1;
+	/* Number of reads in the next batch. It grows while the target keeps
+	 * up, and shrinks when the DMI reports busy. */
+	size_t batch_reads = 32;
+	unsigned batches = 0, clean_batches = 0, dmi_busy = 0, ac_busy = 0;
 	while (read_addr < fin_addr) {
 		LOG_DEBUG("read_addr=0x%" PRIx64 ", receive_addr=0x%" PRIx64
 				", fin_addr=0x%" PRIx64, read_addr, receive_addr, fin_addr);
@@ -2102,7 +2237,7 @@ static int read_memory_progbuf(struct target *target, target_addr_t address,
 		LOG_DEBUG("creating burst to read from 0x%" PRIx64
 				" up to 0x%" PRIx64, read_addr, fin_addr);
 		assert(read_addr >= address && read_addr < fin_addr);
-		struct riscv_batch *batch = riscv_batch_alloc(target, 32,
+		struct riscv_batch *batch = riscv_batch_alloc(target, batch_reads,
 				info->dmi_busy_delay + info->ac_busy_delay);
 
 		size_t reads = 0;
@@ -2114,28 +2249,56 @@ static int read_memory_progbuf(struct target *target, target_addr_t address,
 				break;
 		}
 
-		riscv_batch_run(batch);
+		result = riscv_batch_run(batch);
+		if (result != ERROR_OK) {
+			riscv_batch_free(batch);
+			goto error;
+		}
+		batches++;
+
+		/* DMI busy is sticky: once a read came back busy, the DM ignored all
+		 * the following ones, so only the reads before it are valid. The
+		 * dmi_read() of abstractcs below notices the busy, clears it and
+		 * increases dmi_busy_delay. */
+		size_t good_reads = reads;
+		for (size_t i = 0; i < reads; i++) {
+			uint64_t dmi_out = riscv_batch_get_dmi_read(batch, i);
+			if (get_field(dmi_out, DTM_DMI_OP) != DMI_STATUS_SUCCESS) {
+				LOG_DEBUG("DMI busy after %d of %d reads", (int) i, (int) reads);
+				good_reads = i;
+				dmi_busy++;
+				break;
+			}
+		}
 
 		/* Wait for the target to finish performing the last abstract command,
 		 * and update our copy of cmderr. */
 		uint32_t abstractcs;
-		if (dmi_read(target, &abstractcs, DMI_ABSTRACTCS) != ERROR_OK)
-			return ERROR_FAIL;
+		if (dmi_read(target, &abstractcs, DMI_ABSTRACTCS) != ERROR_OK) {
+			riscv_batch_free(batch);
+			result = ERROR_FAIL;
+			goto error;
+		}
 		while (get_field(abstractcs, DMI_ABSTRACTCS_BUSY))
-			if (dmi_read(target, &abstractcs, DMI_ABSTRACTCS) != ERROR_OK)
-				return ERROR_FAIL;
+			if (dmi_read(target, &abstractcs, DMI_ABSTRACTCS) != ERROR_OK) {
+				riscv_batch_free(batch);
+				result = ERROR_FAIL;
+				goto error;
+			}
 		info->cmderr = get_field(abstractcs, DMI_ABSTRACTCS_CMDERR);
 
 		unsigned cmderr = info->cmderr;
-		riscv_addr_t next_read_addr;
+		riscv_addr_t next_read_addr = fin_addr;
 		uint32_t dmi_data0 = -1;
 		switch (info->cmderr) {
 			case CMDERR_NONE:
 				LOG_DEBUG("successful (partial?) memory read");
-				next_read_addr = read_addr + reads * size;
+				if (good_reads == reads)
+					next_read_addr = read_addr + reads * size;
 				break;
 			case CMDERR_BUSY:
 				LOG_DEBUG("memory read resulted in busy response");
+				ac_busy++;
 
 				/*
 				 * If you want to exercise this code path, apply the following patch to spike:
@@ -2171,8 +2334,10 @@ static int read_memory_progbuf(struct target *target, target_addr_t address,
 
 				/* This is definitely a good version of the value that we
 				 * attempted to read when we discovered that the target was
-				 * busy. */
-				if (dmi_read(target, &dmi_data0, DMI_DATA0) != ERROR_OK) {
+				 * busy. After a DMI busy we restart from the first missing
+				 * word below instead. */
+				if (good_reads == reads &&
+						dmi_read(target, &dmi_data0, DMI_DATA0) != ERROR_OK) {
 					riscv_batch_free(batch);
 					goto error;
 				}
@@ -2184,6 +2349,9 @@ static int read_memory_progbuf(struct target *target, target_addr_t address,
 					riscv_batch_free(batch);
 					goto error;
 				}
+				if (good_reads < reads)
+					break;
+
 				/* Restore the command, and execute it.
 				 * Now DMI_DATA0 contains the next value just as it would if no
 				 * error had occurred. */
@@ -2201,7 +2369,7 @@ static int read_memory_progbuf(struct target *target, target_addr_t address,
 		}
 
 		/* Now read whatever we got out of the batch. */
-		for (size_t i = 0; i < reads; i++) {
+		for (size_t i = 0; i < good_reads; i++) {
 			if (read_addr >= next_read_addr)
 				break;
 
@@ -2222,18 +2390,39 @@ static int read_memory_progbuf(struct target *target, target_addr_t address,
 		}
 		riscv_batch_free(batch);
 
+		if (good_reads < reads) {
+			/* Start over from the first word we didn't receive, with a
+			 * smaller batch so that less work is lost on the next busy. */
+			batch_reads = MAX(batch_reads / 2, 8);
+			clean_batches = 0;
+			dmi_write(target, DMI_ABSTRACTAUTO, 0);
+			result = read_memory_progbuf_start(target, receive_addr, command);
+			if (result != ERROR_OK)
+				goto error;
+			read_addr = receive_addr + size;
+			skip = 1;
+			continue;
+		}
+
 		if (cmderr == CMDERR_BUSY) {
 			riscv_addr_t offset = receive_addr - address;
 			write_to_buf(buffer + offset, dmi_data0, size);
 			log_memory_access(receive_addr, dmi_data0, size, true);
 			read_addr += size;
 			receive_addr += size;
+			clean_batches = 0;
+		} else if (++clean_batches >= RISCV013_CLEAN_BATCHES_BEFORE_DECAY) {
+			/* The target keeps up: try with less idle time, and with
+			 * larger batches. */
+			decrease_busy_delays(target);
+			batch_reads = MIN(batch_reads * 2, RISCV013_MAX_BATCH_READS);
+			clean_batches = 0;
 		}
 	}
 
 	dmi_write(target, DMI_ABSTRACTAUTO, 0);
 
-	if (count > 1) {
+	if (receive_addr + size < fin_addr) {
 		/* Read the penultimate word. */
 		uint32_t value;
 		if (dmi_read(target, &value, DMI_DATA0) != ERROR_OK)
@@ -2251,6 +2440,10 @@ static int read_memory_progbuf(struct target *target, target_addr_t address,
 	write_to_buf(buffer + receive_addr - address, value, size);
 	log_memory_access(receive_addr, value, size, true);
 
+	LOG_DEBUG("read %d words in %u batches, %u DMI busy, %u abstract busy, "
+			"dmi_busy_delay=%d, ac_busy_delay=%d", count, batches, dmi_busy,
+			ac_busy, info->dmi_busy_delay, info->ac_busy_delay);
+
 	riscv_set_register(target, GDB_REGNO_S0, s0);
 	riscv_set_register(target, GDB_REGNO_S1, s1);
 	return ERROR_OK;
@@ -2376,6 +2569,13 @@ static int write_memory_bus_v0(struct target *target, target_addr_t address,
 	return ERROR_OK;
 }
 
+/**
+ * Write the requested memory using the system bus interface.
+ *
+ * The writes are streamed with sbautoincrement, in batches of DMI scans. sbcs
+ * is only checked once per batch. If the bus or the DMI was busy, the
+ * transfer is restarted from the address the bus stopped at.
+ */
 static int write_memory_bus_v1(struct target *target, target_addr_t address,
 		uint32_t size, uint32_t count, const uint8_t *buffer)
 {
@@ -2386,25 +2586,34 @@ static int write_memory_bus_v1(struct target *target, target_addr_t address,
 
 	target_addr_t next_address = address;
 	target_addr_t end_address = address + count * size;
+	uint32_t words_per_batch = MAX(RISCV013_MAX_SBA_BATCH_SCANS /
+			sb_data_regs(size), 1);
+	unsigned batches = 0;
 
 	sb_write_address(target, next_address);
 	while (next_address < end_address) {
-		for (uint32_t i = (next_address - address) / size; i < count; i++) {
+		uint32_t first = (next_address - address) / size;
+		uint32_t words = MIN(count - first, words_per_batch);
+		struct riscv_batch *batch = riscv_batch_alloc(target,
+				words * sb_data_regs(size),
+				info->dmi_busy_delay + info->bus_master_write_delay);
+
+		for (uint32_t i = first; i < first + words; i++) {
 			const uint8_t *p = buffer + i * size;
 			if (size > 12)
-				dmi_write(target, DMI_SBDATA3,
+				riscv_batch_add_dmi_write(batch, DMI_SBDATA3,
 						((uint32_t) p[12]) |
 						(((uint32_t) p[13]) << 8) |
 						(((uint32_t) p[14]) << 16) |
 						(((uint32_t) p[15]) << 24));
 			if (size > 8)
-				dmi_write(target, DMI_SBDATA2,
+				riscv_batch_add_dmi_write(batch, DMI_SBDATA2,
 						((uint32_t) p[8]) |
 						(((uint32_t) p[9]) << 8) |
 						(((uint32_t) p[10]) << 16) |
 						(((uint32_t) p[11]) << 24));
 			if (size > 4)
-				dmi_write(target, DMI_SBDATA1,
+				riscv_batch_add_dmi_write(batch, DMI_SBDATA1,
 						((uint32_t) p[4]) |
 						(((uint32_t) p[5]) << 8) |
 						(((uint32_t) p[6]) << 16) |
@@ -2416,18 +2625,22 @@ static int write_memory_bus_v1(struct target *target, target_addr_t address,
 			}
 			if (size > 1)
 				value |= ((uint32_t) p[1]) << 8;
-			dmi_write(target, DMI_SBDATA0, value);
+			riscv_batch_add_dmi_write(batch, DMI_SBDATA0, value);
 
 			log_memory_access(address + i * size, value, size, false);
+		}
 
-			if (info->bus_master_write_delay) {
-				jtag_add_runtest(info->bus_master_write_delay, TAP_IDLE);
-				if (jtag_execute_queue() != ERROR_OK) {
-					LOG_ERROR("Failed to scan idle sequence");
-					return ERROR_FAIL;
-				}
-			}
+		if (riscv_batch_run(batch) != ERROR_OK) {
+			riscv_batch_free(batch);
+			return ERROR_FAIL;
 		}
+		batches++;
+
+		/* If the DMI was busy, the writes following the busy one were
+		 * dropped. The read of sbcs below clears the busy state and increases
+		 * dmi_busy_delay. */
+		bool dmi_busy = riscv_batch_get_dmi_status(batch) != DMI_STATUS_SUCCESS;
+		riscv_batch_free(batch);
 
 		if (read_sbcs_nonbusy(target, &sbcs) != ERROR_OK)
 			return ERROR_FAIL;
@@ -2441,16 +2654,26 @@ static int write_memory_bus_v1(struct target *target, target_addr_t address,
 		}
 
 		unsigned error = get_field(sbcs, DMI_SBCS_SBERROR);
-		if (error == 0) {
-			next_address = end_address;
-		} else {
+		if (error != 0) {
 			/* Some error indicating the bus access failed, but not because of
 			 * something we did wrong. */
 			dmi_write(target, DMI_SBCS, DMI_SBCS_SBERROR);
 			return ERROR_FAIL;
 		}
+
+		if (dmi_busy) {
+			/* sbaddress was only incremented by the writes that made it. */
+			next_address = sb_read_address(target);
+			LOG_DEBUG("DMI busy, restarting at 0x%" TARGET_PRIxADDR,
+					next_address);
+			continue;
+		}
+
+		next_address += words * size;
 	}
 
+	LOG_DEBUG("wrote %d words in %u batches, bus_master_write_delay=%d",
+			count, batches, info->bus_master_write_delay);
 	return ERROR_OK;
 }
 
@@ -2689,8 +2912,14 @@ struct target_type riscv013_target = {
 static int riscv013_get_register(struct target *target,
 		riscv_reg_t *value, int hid, int rid)
 {
+	RISCV_INFO(r);
 	LOG_DEBUG("reading register %s on hart %d", gdb_regno_name(rid), hid);
 
+	if (r->valid_saved_registers[hid][rid]) {
+		*value = r->saved_registers[hid][rid];
+		return ERROR_OK;
+	}
+
 	riscv_set_current_hartid(target, hid);
 
 	int result = ERROR_OK;
@@ -2712,9 +2941,12 @@ static int riscv013_get_register(struct target *target,
 
 static int riscv013_set_register(struct target *target, int hid, int rid, uint64_t value)
 {
+	RISCV_INFO(r);
 	LOG_DEBUG("writing 0x%" PRIx64 " to register %s on hart %d", value,
 			gdb_regno_name(rid), hid);
 
+	r->valid_saved_registers[hid][rid] = false;
+
 	riscv_set_current_hartid(target, hid);
 
 	if (rid <= GDB_REGNO_XPR31) {
@@ -2821,6 +3053,197 @@ static int riscv013_on_halt(struct target *target)
 	return ERROR_OK;
 }
 
+/* Select all the enabled harts in mask through the hart array mask, with
+ * hartsel pointing at the first of them. Returns the dmcontrol value to use
+ * while they are selected. */
+static uint32_t select_hart_group(struct target *target, uint32_t mask)
+{
+	dm013_info_t *dm = get_dm(target);
+	int first = 0;
+	while (!(mask & (1u << first)))
+		first++;
+
+	dmi_write(target, DMI_HAWINDOWSEL, 0);
+	dmi_write(target, DMI_HAWINDOW, mask);
+	dm->current_hartid = first;
+	return set_hartsel(DMI_DMCONTROL_DMACTIVE | DMI_DMCONTROL_HASEL, first);
+}
+
+/* Wait until all the harts selected by select_hart_group() have the given
+ * dmstatus field set. */
+static int wait_for_hart_group(struct target *target, uint32_t field)
+{
+	time_t start = time(NULL);
+	uint32_t dmstatus;
+	while (1) {
+		if (dmstatus_read(target, &dmstatus, true) != ERROR_OK)
+			return ERROR_FAIL;
+		if (get_field(dmstatus, field))
+			return ERROR_OK;
+		if (time(NULL) - start > riscv_command_timeout_sec) {
+			LOG_ERROR("Timed out after %ds waiting for a group of harts "
+					"(dmstatus=0x%x). Increase the timeout with riscv "
+					"set_command_timeout_sec.",
+					riscv_command_timeout_sec, dmstatus);
+			return ERROR_FAIL;
+		}
+		keep_alive();
+	}
+}
+
+static uint32_t enabled_harts_mask(struct target *target)
+{
+	uint32_t mask = 0;
+	for (int i = 0; i < riscv_count_harts(target); ++i)
+		if (riscv_hart_enabled(target, i))
+			mask |= 1u << i;
+	return mask;
+}
+
+static int riscv013_halt_all_harts(struct target *target)
+{
+	RISCV013_INFO(info);
+	if (!info->hasel_supported || !riscv_rtos_enabled(target))
+		return ERROR_TARGET_RESOURCE_NOT_AVAILABLE;
+
+	uint32_t mask = enabled_harts_mask(target);
+	if (!mask)
+		return ERROR_OK;
+	LOG_DEBUG("halting harts 0x%x", mask);
+
+	/* Issue the halt request to the whole group, and then wait for every
+	 * hart of the group to halt. */
+	uint32_t dmcontrol = select_hart_group(target, mask);
+	dmi_write(target, DMI_DMCONTROL, dmcontrol | DMI_DMCONTROL_HALTREQ);
+	int result = wait_for_hart_group(target, DMI_DMSTATUS_ALLHALTED);
+	dmi_write(target, DMI_DMCONTROL, dmcontrol & ~DMI_DMCONTROL_HASEL);
+	if (result != ERROR_OK)
+		LOG_ERROR("unable to halt harts 0x%x", mask);
+	return result;
+}
+
+static int riscv013_resume_all_harts(struct target *target)
+{
+	RISCV_INFO(r);
+	RISCV013_INFO(info);
+	if (!info->hasel_supported || !riscv_rtos_enabled(target))
+		return ERROR_TARGET_RESOURCE_NOT_AVAILABLE;
+
+	/* Prepare each halted hart for resuming. Running harts are left out of
+	 * the group, as they would never acknowledge the resume request. */
+	uint32_t mask = 0;
+	for (int i = 0; i < riscv_count_harts(target); ++i) {
+		if (!riscv_hart_enabled(target, i))
+			continue;
+		if (riscv_set_current_hartid(target, i) != ERROR_OK)
+			return ERROR_FAIL;
+		if (!riscv_is_halted(target)) {
+			LOG_DEBUG("  hart %d requested resume, but was already resumed", i);
+			continue;
+		}
+		if (r->on_resume(target) != ERROR_OK)
+			return ERROR_FAIL;
+		mask |= 1u << i;
+	}
+	if (!mask)
+		return ERROR_OK;
+	LOG_DEBUG("resuming harts 0x%x", mask);
+
+	uint32_t dmcontrol = select_hart_group(target, mask);
+	dmi_write(target, DMI_DMCONTROL, dmcontrol | DMI_DMCONTROL_RESUMEREQ);
+	int result = wait_for_hart_group(target, DMI_DMSTATUS_ALLRESUMEACK);
+	dmi_write(target, DMI_DMCONTROL, dmcontrol & ~DMI_DMCONTROL_HASEL);
+	if (result != ERROR_OK)
+		LOG_ERROR("unable to resume harts 0x%x", mask);
+	return result;
+}
+
+/**
+ * Read the GPRs and PC of all the enabled harts, which must be halted, in a
+ * single batch, and keep them in saved_registers until the harts are resumed.
+ */
+static int riscv013_snapshot_registers(struct target *target)
+{
+	RISCV_INFO(r);
+	RISCV013_INFO(info);
+	dm013_info_t *dm = get_dm(target);
+
+	/* x1..x31, and the PC read from DPC. */
+	unsigned last_reg = info->abstract_read_csr_supported ? GDB_REGNO_PC :
+		GDB_REGNO_XPR31;
+	size_t keys[RISCV_MAX_HARTS][GDB_REGNO_PC + 1];
+	int harts = riscv_count_harts(target);
+	int last_hart = -1;
+
+	select_dmi(target);
+
+	/* One hartsel write, then a command and up to two data reads for each
+	 * register. */
+	struct riscv_batch *batch = riscv_batch_alloc(target,
+			harts * (1 + 3 * last_reg),
+			info->dmi_busy_delay + info->ac_busy_delay);
+	for (int h = 0; h < harts; ++h) {
+		if (!riscv_hart_enabled(target, h))
+			continue;
+		riscv_batch_add_dmi_write(batch, DMI_DMCONTROL,
+				set_hartsel(DMI_DMCONTROL_DMACTIVE, h));
+		last_hart = h;
+		for (unsigned reg = GDB_REGNO_ZERO + 1; reg <= last_reg; ++reg) {
+			unsigned number = reg == GDB_REGNO_PC ? GDB_REGNO_DPC : reg;
+			riscv_batch_add_dmi_write(batch, DMI_COMMAND,
+					access_register_command(number, r->xlen[h],
+						AC_ACCESS_REGISTER_TRANSFER));
+			keys[h][reg] = riscv_batch_add_dmi_read(batch, DMI_DATA0);
+			if (r->xlen[h] > 32)
+				riscv_batch_add_dmi_read(batch, DMI_DATA1);
+		}
+	}
+	if (last_hart < 0) {
+		riscv_batch_free(batch);
+		return ERROR_OK;
+	}
+
+	int result = riscv_batch_run(batch);
+	dm->current_hartid = last_hart;
+	if (result == ERROR_OK &&
+			riscv_batch_get_dmi_status(batch) != DMI_STATUS_SUCCESS) {
+		LOG_DEBUG("DMI busy while taking the register snapshot");
+		result = ERROR_FAIL;
+	}
+
+	/* Abstract command errors are sticky too: a single check tells whether
+	 * every command of the batch completed. */
+	uint32_t abstractcs;
+	if (dmi_read(target, &abstractcs, DMI_ABSTRACTCS) != ERROR_OK)
+		result = ERROR_FAIL;
+	else if (get_field(abstractcs, DMI_ABSTRACTCS_CMDERR) != CMDERR_NONE) {
+		LOG_DEBUG("register snapshot failed, abstractcs=0x%x", abstractcs);
+		if (get_field(abstractcs, DMI_ABSTRACTCS_CMDERR) == CMDERR_BUSY)
+			increase_ac_busy_delay(target);
+		riscv013_clear_abstract_error(target);
+		result = ERROR_FAIL;
+	}
+
+	/* Without a snapshot, registers are simply read one at a time. */
+	for (int h = 0; result == ERROR_OK && h < harts; ++h) {
+		if (!riscv_hart_enabled(target, h))
+			continue;
+		for (unsigned reg = GDB_REGNO_ZERO + 1; reg <= last_reg; ++reg) {
+			uint64_t value = get_field(riscv_batch_get_dmi_read(batch,
+						keys[h][reg]), DTM_DMI_DATA);
+			if (r->xlen[h] > 32)
+				value |= get_field(riscv_batch_get_dmi_read(batch,
+							keys[h][reg] + 1), DTM_DMI_DATA) << 32;
+			r->saved_registers[h][reg] = value;
+			r->valid_saved_registers[h][reg] = true;
+		}
+		r->saved_registers[h][GDB_REGNO_ZERO] = 0;
+		r->valid_saved_registers[h][GDB_REGNO_ZERO] = true;
+	}
+	riscv_batch_free(batch);
+	return result;
+}
+
 static bool riscv013_is_halted(struct target *target)
 {
 	uint32_t dmstatus;
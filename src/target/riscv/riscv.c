@@ -719,6 +719,8 @@ static int old_or_new_riscv_halt(struct target *target)
 static int riscv_assert_reset(struct target *target)
 {
 	struct target_type *tt = get_target_type(target);
+	for (int i = 0; i < riscv_count_harts(target); ++i)
+		riscv_invalidate_saved_registers(target, i);
 	return tt->assert_reset(target);
 }
 
@@ -953,16 +955,140 @@ static int riscv_run_algorithm(struct target *target, int num_mem_params,
 	return ERROR_OK;
 }
 
-/* Should run code on the target to perform CRC of
-memory. Not yet implemented.
-*/
+/* Computes the CRCs of an array of memory regions in a single algorithm
+ * run, returning the number of regions done or an error code. */
+static int riscv_checksum_memory_blocks(struct target *target,
+		struct target_memory_check_block *blocks, int num_blocks)
+{
+	struct working_area *crc_algorithm;
+	struct working_area *crc_params;
+	struct reg_param reg_params[1];
+	int xlen = riscv_xlen(target);
+	int retval;
+
+	/* RV32I code which runs unchanged on RV64I */
+	static const uint8_t crc_blocks_code[] = {
+#include "../../../contrib/loaders/checksum/riscv_crc_blocks.inc"
+	};
+
+	const uint32_t code_size = sizeof(crc_blocks_code);
+
+	if (target_alloc_working_area(target, code_size,
+			&crc_algorithm) != ERROR_OK)
+		return ERROR_TARGET_RESOURCE_NOT_AVAILABLE;
+
+	retval = target_write_buffer(target, crc_algorithm->address,
+			code_size, crc_blocks_code);
+	if (retval != ERROR_OK)
+		goto cleanup1;
+
+	/* little endian { uint32_t size_in_crc_out, uint32_t address } pairs,
+	 * ended by a zero size */
+	uint32_t avail = target_get_working_area_avail(target);
+	int blocks_to_check = avail / 8 - 1;
+	if (num_blocks < blocks_to_check)
+		blocks_to_check = num_blocks;
+	if (blocks_to_check < 1) {
+		retval = ERROR_TARGET_RESOURCE_NOT_AVAILABLE;
+		goto cleanup1;
+	}
+
+	uint8_t *params = malloc((blocks_to_check + 1) * 8);
+	if (params == NULL) {
+		retval = ERROR_FAIL;
+		goto cleanup1;
+	}
+
+	int i;
+	uint32_t total_size = 0;
+	for (i = 0; i < blocks_to_check; i++) {
+		/* a zero size would end the array early, the kernel only
+		 * handles 32 bit addresses */
+		if (blocks[i].size == 0 || blocks[i].address > UINT32_MAX)
+			break;
+		total_size += blocks[i].size;
+		h_u32_to_le(params + 8 * i, blocks[i].size);
+		h_u32_to_le(params + 8 * i + 4, blocks[i].address);
+	}
+	blocks_to_check = i;
+	if (blocks_to_check == 0) {
+		retval = 0;
+		goto cleanup2;
+	}
+	h_u32_to_le(params + 8 * blocks_to_check, 0);
+
+	uint32_t param_size = (blocks_to_check + 1) * 8;
+	if (target_alloc_working_area(target, param_size,
+			&crc_params) != ERROR_OK) {
+		retval = ERROR_TARGET_RESOURCE_NOT_AVAILABLE;
+		goto cleanup2;
+	}
+
+	retval = target_write_buffer(target, crc_params->address,
+			param_size, params);
+	if (retval != ERROR_OK)
+		goto cleanup3;
+
+	LOG_DEBUG("Starting checksum of %d blocks, parameters@"
+		 TARGET_ADDR_FMT, blocks_to_check, crc_params->address);
+
+	init_reg_param(&reg_params[0], "a0", xlen, PARAM_OUT);
+	buf_set_u64(reg_params[0].value, 0, xlen, crc_params->address);
+
+	int timeout = 20000 * (1 + (total_size / (1024 * 1024)));
+
+	/* the kernel ends with an ebreak */
+	retval = target_run_algorithm(target, 0, NULL,
+			ARRAY_SIZE(reg_params), reg_params,
+			crc_algorithm->address,
+			crc_algorithm->address + code_size - 4,
+			timeout, NULL);
+	if (retval != ERROR_OK) {
+		LOG_ERROR("error executing RISC-V crc blocks algorithm");
+		goto cleanup4;
+	}
+
+	retval = target_read_buffer(target, crc_params->address,
+			param_size, params);
+	if (retval != ERROR_OK)
+		goto cleanup4;
+
+	for (i = 0; i < blocks_to_check; i++)
+		blocks[i].result = le_to_h_u32(params + 8 * i);
+
+	retval = blocks_to_check;	/* return number of blocks really checked */
+
+cleanup4:
+	destroy_reg_param(&reg_params[0]);
+cleanup3:
+	target_free_working_area(target, crc_params);
+cleanup2:
+	free(params);
+cleanup1:
+	target_free_working_area(target, crc_algorithm);
+
+	return retval;
+}
 
 static int riscv_checksum_memory(struct target *target,
 		target_addr_t address, uint32_t count,
 		uint32_t *checksum)
 {
+	struct target_memory_check_block block = {
+		.address = address,
+		.size = count,
+	};
+
 	*checksum = 0xFFFFFFFF;
-	return ERROR_TARGET_RESOURCE_NOT_AVAILABLE;
+	if (count == 0)
+		return ERROR_OK;
+
+	/* the caller reads the memory and computes the CRC itself */
+	if (riscv_checksum_memory_blocks(target, &block, 1) != 1)
+		return ERROR_TARGET_RESOURCE_NOT_AVAILABLE;
+
+	*checksum = block.result;
+	return ERROR_OK;
 }
 
 /*** OpenOCD Helper Functions ***/
@@ -1028,9 +1154,10 @@ int riscv_openocd_poll(struct target *target)
 		 * the invariant we hold here.	Some harts might have already
 		 * halted (as we're either in single-step mode or they also
 		 * triggered a breakpoint), so don't attempt to halt those
-		 * harts. */
-		for (int i = 0; i < riscv_count_harts(target); ++i)
-			riscv_halt_one_hart(target, i);
+		 * harts. riscv_halt_all_harts() skips disabled harts, but
+		 * with the RTOS enabled every hart is enabled, so this halts
+		 * the same harts the per-hart loop did. */
+		riscv_halt_all_harts(target);
 	} else {
 		enum riscv_poll_hart out = riscv_poll_hart(target,
 				riscv_current_hartid(target));
@@ -1578,6 +1705,7 @@ struct target_type riscv_target = {
 	.write_memory = riscv_write_memory,
 
 	.checksum_memory = riscv_checksum_memory,
+	.checksum_memory_blocks = riscv_checksum_memory_blocks,
 
 	.get_gdb_reg_list = riscv_get_gdb_reg_list,
 
@@ -1615,13 +1743,30 @@ void riscv_info_init(struct target *target, riscv_info_t *r)
 
 int riscv_halt_all_harts(struct target *target)
 {
-	for (int i = 0; i < riscv_count_harts(target); ++i) {
-		if (!riscv_hart_enabled(target, i))
-			continue;
+	RISCV_INFO(r);
+	int result = ERROR_TARGET_RESOURCE_NOT_AVAILABLE;
 
-		riscv_halt_one_hart(target, i);
+	if (r->halt_all_harts)
+		result = r->halt_all_harts(target);
+
+	if (result == ERROR_TARGET_RESOURCE_NOT_AVAILABLE) {
+		result = ERROR_OK;
+		for (int i = 0; i < riscv_count_harts(target); ++i) {
+			if (!riscv_hart_enabled(target, i))
+				continue;
+
+			if (riscv_halt_one_hart(target, i) != ERROR_OK)
+				result = ERROR_FAIL;
+		}
 	}
 
+	/* With several harts, the debugger is going to look at all of them:
+	 * read their registers in one go. */
+	if (result == ERROR_OK && riscv_rtos_enabled(target) &&
+			r->snapshot_registers &&
+			r->snapshot_registers(target) != ERROR_OK)
+		LOG_DEBUG("no register snapshot, registers will be read on demand");
+
 	return ERROR_OK;
 }
 
@@ -1641,11 +1786,22 @@ int riscv_halt_one_hart(struct target *target, int hartid)
 
 int riscv_resume_all_harts(struct target *target)
 {
-	for (int i = 0; i < riscv_count_harts(target); ++i) {
-		if (!riscv_hart_enabled(target, i))
-			continue;
+	RISCV_INFO(r);
+	int result = ERROR_TARGET_RESOURCE_NOT_AVAILABLE;
+
+	for (int i = 0; i < riscv_count_harts(target); ++i)
+		riscv_invalidate_saved_registers(target, i);
 
-		riscv_resume_one_hart(target, i);
+	if (r->resume_all_harts)
+		result = r->resume_all_harts(target);
+
+	if (result == ERROR_TARGET_RESOURCE_NOT_AVAILABLE) {
+		for (int i = 0; i < riscv_count_harts(target); ++i) {
+			if (!riscv_hart_enabled(target, i))
+				continue;
+
+			riscv_resume_one_hart(target, i);
+		}
 	}
 
 	riscv_invalidate_register_cache(target);
@@ -1656,6 +1812,7 @@ int riscv_resume_one_hart(struct target *target, int hartid)
 {
 	RISCV_INFO(r);
 	LOG_DEBUG("resuming hart %d", hartid);
+	riscv_invalidate_saved_registers(target, hartid);
 	if (riscv_set_current_hartid(target, hartid) != ERROR_OK)
 		return ERROR_FAIL;
 	if (!riscv_is_halted(target)) {
@@ -1667,6 +1824,13 @@ int riscv_resume_one_hart(struct target *target, int hartid)
 	return r->resume_current_hart(target);
 }
 
+void riscv_invalidate_saved_registers(struct target *target, int hartid)
+{
+	RISCV_INFO(r);
+	memset(r->valid_saved_registers[hartid], 0,
+			sizeof(r->valid_saved_registers[hartid]));
+}
+
 int riscv_step_rtos_hart(struct target *target)
 {
 	RISCV_INFO(r);
@@ -1687,6 +1851,7 @@ int riscv_step_rtos_hart(struct target *target)
 		return ERROR_FAIL;
 	}
 	riscv_invalidate_register_cache(target);
+	riscv_invalidate_saved_registers(target, hartid);
 	r->on_step(target);
 	if (r->step_current_hart(target) != ERROR_OK)
 		return ERROR_FAIL;
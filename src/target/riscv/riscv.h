@@ -55,6 +55,8 @@ typedef struct {
 
 	/* Enough space to store all the registers we might need to save. */
 	/* FIXME: This should probably be a bunch of register caches. */
+	/* Filled in by snapshot_registers() when all the harts halt, and valid
+	 * until the hart is resumed or the register is written. */
 	uint64_t saved_registers[RISCV_MAX_HARTS][RISCV_MAX_REGISTERS];
 	bool valid_saved_registers[RISCV_MAX_HARTS][RISCV_MAX_REGISTERS];
 
@@ -105,6 +107,14 @@ typedef struct {
 	int (*on_halt)(struct target *target);
 	int (*on_resume)(struct target *target);
 	int (*on_step)(struct target *target);
+	/* Halt or resume all the enabled harts at once. They return
+	 * ERROR_TARGET_RESOURCE_NOT_AVAILABLE if that isn't possible, in which case
+	 * the harts are handled one at a time. */
+	int (*halt_all_harts)(struct target *target);
+	int (*resume_all_harts)(struct target *target);
+	/* Read the registers of all the (halted) enabled harts into
+	 * saved_registers. */
+	int (*snapshot_registers)(struct target *target);
 	enum riscv_halt_reason (*halt_reason)(struct target *target);
 	int (*write_debug_buffer)(struct target *target, unsigned index,
 			riscv_insn_t d);
@@ -179,6 +189,7 @@ int riscv_halt_all_harts(struct target *target);
 int riscv_halt_one_hart(struct target *target, int hartid);
 int riscv_resume_all_harts(struct target *target);
 int riscv_resume_one_hart(struct target *target, int hartid);
+void riscv_invalidate_saved_registers(struct target *target, int hartid);
 
 /* Steps the hart that's currently selected in the RTOS, or if there is no RTOS
  * then the only hart. */
@@ -42,6 +42,7 @@
 #endif
 
 #include <helper/time_support.h>
+#include <helper/lz4.h>
 #include <jtag/jtag.h>
 #include <flash/nor/core.h>
 
@@ -2229,6 +2230,122 @@ static int target_read_buffer_default(struct target *target, target_addr_t addre
 	return ERROR_OK;
 }
 
+/* working area for compressed data, halved until it can be allocated */
+#define TARGET_COMPRESS_AREA_SIZE		(16 * 1024)
+#define TARGET_COMPRESS_AREA_MIN_SIZE	256
+
+/* Sends one block compressed and unpacks it on the target, checking the result
+ * against the checksum of the original data. */
+static int target_write_block_compressed(struct target *target,
+		struct working_area *area, target_addr_t address, uint32_t count,
+		const uint8_t *buffer, const uint8_t *packed, uint32_t packed_size)
+{
+	uint32_t image_crc, target_crc;
+	int retval;
+
+	retval = target_write_buffer(target, area->address, packed_size, packed);
+	if (retval != ERROR_OK)
+		return retval;
+
+	retval = target->type->decompress_memory(target, area->address, packed_size,
+			address, count);
+	if (retval != ERROR_OK)
+		return retval;
+
+	retval = image_calculate_checksum(buffer, count, &image_crc);
+	if (retval == ERROR_OK)
+		retval = target_checksum_memory(target, address, count, &target_crc);
+	if (retval == ERROR_OK && image_crc != target_crc) {
+		LOG_WARNING("unpacked data at " TARGET_ADDR_FMT " doesn't match", address);
+		retval = ERROR_FAIL;
+	}
+
+	return retval;
+}
+
+int target_write_buffer_compressed(struct target *target, target_addr_t address,
+		uint32_t size, const uint8_t *buffer, uint32_t *transferred)
+{
+	struct working_area *area = NULL;
+	uint32_t area_size = TARGET_COMPRESS_AREA_SIZE;
+	uint8_t *packed = NULL;
+	bool compress = target->type->decompress_memory != NULL;
+	int retval = ERROR_OK;
+
+	*transferred = 0;
+
+	if (compress) {
+		while (target_alloc_working_area_try(target, area_size, &area) != ERROR_OK) {
+			area_size /= 2;
+			if (area_size < TARGET_COMPRESS_AREA_MIN_SIZE) {
+				LOG_DEBUG("no working area for compressed download");
+				compress = false;
+				break;
+			}
+		}
+	}
+
+	/* the compressed data must not end up in the way of the unpacked data */
+	if (compress && address < area->address + area->size &&
+			area->address < address + size) {
+		LOG_DEBUG("working area overlaps the download, not compressing");
+		compress = false;
+	}
+
+	if (compress) {
+		packed = malloc(area_size);
+		if (packed == NULL) {
+			LOG_ERROR("Out of memory");
+			compress = false;
+		}
+	}
+
+	while (size > 0) {
+		uint32_t count = size;
+		size_t packed_size = 0;
+
+		if (compress) {
+			/* try a block that packs at least 2:1 first */
+			count = MIN(size, 2 * area_size);
+			packed_size = lz4_compress_block(buffer, count, packed, area_size);
+			if (packed_size == 0) {
+				count = MIN(size, area_size);
+				packed_size = lz4_compress_block(buffer, count, packed, area_size);
+			}
+		}
+
+		if (packed_size > 0 && packed_size < count) {
+			retval = target_write_block_compressed(target, area, address, count,
+					buffer, packed, packed_size);
+			if (retval == ERROR_OK)
+				*transferred += packed_size;
+			else {
+				LOG_WARNING("compressed download failed, "
+						"falling back to uncompressed download");
+				compress = false;
+				packed_size = 0;
+			}
+		}
+
+		if (packed_size == 0 || packed_size >= count) {
+			retval = target_write_buffer(target, address, count, buffer);
+			if (retval != ERROR_OK)
+				break;
+			*transferred += count;
+		}
+
+		address += count;
+		buffer += count;
+		size -= count;
+	}
+
+	free(packed);
+	if (area)
+		target_free_working_area(target, area);
+
+	return retval;
+}
+
 int target_checksum_memory(struct target *target, target_addr_t address, uint32_t size, uint32_t* crc)
 {
 	uint8_t *buffer;
@@ -2269,6 +2386,44 @@ int target_checksum_memory(struct target *target, target_addr_t address, uint32_
 	return retval;
 }
 
+int target_checksum_memory_blocks(struct target *target,
+	struct target_memory_check_block *blocks, int num_blocks)
+{
+	int done = 0;
+	int retval;
+
+	if (!target_was_examined(target)) {
+		LOG_ERROR("Target not examined yet");
+		return ERROR_FAIL;
+	}
+
+	while (target->type->checksum_memory_blocks && done < num_blocks) {
+		if (blocks[done].size == 0) {
+			blocks[done++].result = 0xffffffff;	/* CRC of no data */
+			continue;
+		}
+		retval = target->type->checksum_memory_blocks(target,
+				blocks + done, num_blocks - done);
+		if (retval < 1)
+			break;
+		done += retval;	/* add number of blocks done this round */
+	}
+
+	/* one region at a time for whatever is left */
+	for (; done < num_blocks; done++) {
+		if (blocks[done].size == 0) {
+			blocks[done].result = 0xffffffff;	/* CRC of no data */
+			continue;
+		}
+		retval = target_checksum_memory(target, blocks[done].address,
+				blocks[done].size, &blocks[done].result);
+		if (retval != ERROR_OK)
+			return retval;
+	}
+
+	return ERROR_OK;
+}
+
 int target_blank_check_memory(struct target *target,
 	struct target_memory_check_block *blocks, int num_blocks,
 	uint8_t erased_value)
@@ -3347,8 +3502,16 @@ COMMAND_HANDLER(handle_load_image_command)
 	uint32_t image_size;
 	target_addr_t min_address = 0;
 	target_addr_t max_address = -1;
+	uint32_t transferred = 0;
 	int i;
 	struct image image;
+	bool compress = false;
+
+	if (CMD_ARGC > 0 && strcmp(CMD_ARGV[0], "compress") == 0) {
+		compress = true;
+		CMD_ARGV++;
+		CMD_ARGC--;
+	}
 
 	int retval = CALL_COMMAND_HANDLER(parse_load_image_command_CMD_ARGV,
 			&image, &min_address, &max_address);
@@ -3398,8 +3561,15 @@ COMMAND_HANDLER(handle_load_image_command)
 			if (image.sections[i].base_address + buf_cnt > max_address)
 				length -= (image.sections[i].base_address + buf_cnt)-max_address;
 
-			retval = target_write_buffer(target,
-					image.sections[i].base_address + offset, length, buffer + offset);
+			if (compress) {
+				uint32_t sent;
+				retval = target_write_buffer_compressed(target,
+						image.sections[i].base_address + offset, length,
+						buffer + offset, &sent);
+				transferred += sent;
+			} else
+				retval = target_write_buffer(target,
+						image.sections[i].base_address + offset, length, buffer + offset);
 			if (retval != ERROR_OK) {
 				free(buffer);
 				break;
@@ -3417,6 +3587,10 @@ COMMAND_HANDLER(handle_load_image_command)
 		command_print(CMD_CTX, "downloaded %" PRIu32 " bytes "
 				"in %fs (%0.3f KiB/s)", image_size,
 				duration_elapsed(&bench), duration_kbps(&bench, image_size));
+		if (compress)
+			command_print(CMD_CTX, "transferred %" PRIu32 " bytes compressed "
+					"(%0.3f KiB/s on the link)", transferred,
+					duration_kbps(&bench, transferred));
 	}
 
 	image_close(&image);
@@ -3537,6 +3711,24 @@ static COMMAND_HELPER(handle_verify_image_command_internal, enum verify_mode ver
 	image_size = 0x0;
 	int diffs = 0;
 	retval = ERROR_OK;
+
+	/* checksum all sections in target memory in as few algorithm runs as possible */
+	struct target_memory_check_block *mem_blocks = NULL;
+	if (verify >= IMAGE_VERIFY && image.num_sections > 1) {
+		mem_blocks = malloc(image.num_sections * sizeof(*mem_blocks));
+		if (mem_blocks != NULL) {
+			for (i = 0; i < image.num_sections; i++) {
+				mem_blocks[i].address = image.sections[i].base_address;
+				mem_blocks[i].size = image.sections[i].size;
+			}
+			if (target_checksum_memory_blocks(target, mem_blocks,
+					image.num_sections) != ERROR_OK) {
+				free(mem_blocks);
+				mem_blocks = NULL;
+			}
+		}
+	}
+
 	for (i = 0; i < image.num_sections; i++) {
 		buffer = malloc(image.sections[i].size);
 		if (buffer == NULL) {
@@ -3559,7 +3751,11 @@ static COMMAND_HELPER(handle_verify_image_command_internal, enum verify_mode ver
 				break;
 			}
 
-			retval = target_checksum_memory(target, image.sections[i].base_address, buf_cnt, &mem_checksum);
+			if (mem_blocks != NULL && buf_cnt == mem_blocks[i].size)
+				mem_checksum = mem_blocks[i].result;
+			else
+				retval = target_checksum_memory(target, image.sections[i].base_address,
+						buf_cnt, &mem_checksum);
 			if (retval != ERROR_OK) {
 				free(buffer);
 				break;
@@ -3621,6 +3817,7 @@ static COMMAND_HELPER(handle_verify_image_command_internal, enum verify_mode ver
 	if (diffs > 0)
 		command_print(CMD_CTX, "No more differences found.");
 done:
+	free(mem_blocks);
 	if (diffs > 0)
 		retval = ERROR_FAIL;
 	if ((ERROR_OK == retval) && (duration_measure(&bench) == ERROR_OK)) {
@@ -6478,7 +6675,7 @@ static const struct command_registration target_exec_command_handlers[] = {
 		.name = "load_image",
 		.handler = handle_load_image_command,
 		.mode = COMMAND_EXEC,
-		.usage = "filename address ['bin'|'ihex'|'elf'|'s19'] "
+		.usage = "['compress'] filename address ['bin'|'ihex'|'elf'|'s19'] "
 			"[min_address] [max_length]",
 	},
 	{
@@ -600,8 +600,22 @@ int target_write_buffer(struct target *target,
 		target_addr_t address, uint32_t size, const uint8_t *buffer);
 int target_read_buffer(struct target *target,
 		target_addr_t address, uint32_t size, uint8_t *buffer);
+/**
+ * Like target_write_buffer(), but sends the data LZ4 compressed and unpacks
+ * it on the target, if the target supports it. Falls back to a plain write
+ * otherwise. @a transferred returns the number of bytes actually sent.
+ */
+int target_write_buffer_compressed(struct target *target, target_addr_t address,
+		uint32_t size, const uint8_t *buffer, uint32_t *transferred);
 int target_checksum_memory(struct target *target,
 		target_addr_t address, uint32_t size, uint32_t *crc);
+/**
+ * Computes the checksums of an array of memory regions into their result
+ * fields, using as few target algorithm runs as possible and falling back
+ * to target_checksum_memory() for the blocks the target can't handle.
+ */
+int target_checksum_memory_blocks(struct target *target,
+		struct target_memory_check_block *blocks, int num_blocks);
 int target_blank_check_memory(struct target *target,
 		struct target_memory_check_block *blocks, int num_blocks,
 		uint8_t erased_value);
@@ -133,6 +133,21 @@ struct target_type {
 	int (*blank_check_memory)(struct target *target,
 			struct target_memory_check_block *blocks, int num_blocks,
 			uint8_t erased_value);
+	/**
+	 * Optional: computes the checksums of an array of memory regions in
+	 * one go, storing them in the result fields. Like blank_check_memory
+	 * it returns the number of blocks processed, or an error code.
+	 */
+	int (*checksum_memory_blocks)(struct target *target,
+			struct target_memory_check_block *blocks, int num_blocks);
+	/**
+	 * Optional: unpack the LZ4 block of @a src_size bytes at @a src in
+	 * target memory to @a dst, which must receive @a dst_size bytes.
+	 * Returns ERROR_TARGET_RESOURCE_NOT_AVAILABLE if it can't be done,
+	 * the caller then writes the data unpacked.
+	 */
+	int (*decompress_memory)(struct target *target, target_addr_t src,
+			uint32_t src_size, target_addr_t dst, uint32_t dst_size);
 
 	/*
 	 * target break-/watchpoint control